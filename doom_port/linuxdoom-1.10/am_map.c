@@ -24,6 +24,7 @@
 static const char rcsid[] = "$Id: am_map.c,v 1.4 1997/02/03 21:24:33 b1 Exp $";
 
 #include <stdio.h>
+#include <string.h>
 
 
 #include "z_zone.h"
@@ -31,6 +32,7 @@ static const char rcsid[] = "$Id: am_map.c,v 1.4 1997/02/03 21:24:33 b1 Exp $";
 #include "st_stuff.h"
 #include "p_local.h"
 #include "w_wad.h"
+#include "m_bbox.h"
 
 #include "m_cheat.h"
 #include "i_system.h"
@@ -289,6 +291,41 @@ static cheatseq_t cheat_amap = { cheat_amap_seq, 0 };
 
 static boolean stopped = true;
 
+
+//
+// The automap's own copy of the lines, built once per level
+//  so drawing walks one compact array instead of lines[].
+// What colour a line gets only depends on its sectors' heights
+//  once the level is loaded, so that is kept too,
+//  and redone for the sectors T_MovePlane has touched.
+//
+typedef enum
+{
+    amc_wall,		// one sided
+    amc_teleport,
+    amc_secret,		// secret door
+    amc_floor,		// floor level change
+    amc_ceiling,	// ceiling level change
+    amc_plain,		// two sided, nothing changes
+    NUMAMCLASSES
+
+} amclass_t;
+
+typedef struct
+{
+    mline_t	l;
+    fixed_t	bbox[4];
+    short	amclass;
+    short	flags;		// ML_MAPPED and LINE_NEVERSEE of the line
+
+} amline_t;
+
+static amline_t*	amlines;	// [numlines]
+
+// Line numbers in the order they were first seen.
+static int*		seenlines;	// [numlines]
+static int		numseen;
+
 extern boolean viewactive;
 //extern byte screens[][SCREENWIDTH*SCREENHEIGHT];
 
@@ -1114,52 +1151,153 @@ void AM_drawGrid(int color)
 // Determines visible lines, draws them.
 // This is LineDef based, not LineSeg based.
 //
+//
+// AM_classifyLine
+//
+void AM_classifyLine(int i)
+{
+    line_t*	li = &lines[i];
+    amline_t*	al = &amlines[i];
+
+    if (!li->backsector)
+	al->amclass = amc_wall;
+    else if (li->special == 39)
+	al->amclass = amc_teleport;
+    else if (li->flags & ML_SECRET)
+	al->amclass = amc_secret;
+    else if (li->backsector->floorheight != li->frontsector->floorheight)
+	al->amclass = amc_floor;
+    else if (li->backsector->ceilingheight != li->frontsector->ceilingheight)
+	al->amclass = amc_ceiling;
+    else
+	al->amclass = amc_plain;
+}
+
+
+//
+// AM_InitLines
+//
+void AM_InitLines(void)
+{
+    int		i;
+    line_t*	li;
+    amline_t*	al;
+
+    // freed with the level, which clears the pointers
+    if (!amlines)
+    {
+	amlines = Z_Malloc(numlines*sizeof(*amlines), PU_LEVEL, &amlines);
+	seenlines = Z_Malloc(numlines*sizeof(*seenlines), PU_LEVEL, &seenlines);
+    }
+
+    numseen = 0;
+    for (i=0, li=lines, al=amlines ; i<numlines ; i++, li++, al++)
+    {
+	al->l.a.x = li->v1->x;
+	al->l.a.y = li->v1->y;
+	al->l.b.x = li->v2->x;
+	al->l.b.y = li->v2->y;
+	memcpy(al->bbox, li->bbox, sizeof(al->bbox));
+	al->flags = li->flags & (ML_MAPPED|LINE_NEVERSEE);
+	AM_classifyLine(i);
+
+	if (li->flags & ML_MAPPED)
+	    seenlines[numseen++] = i;
+    }
+
+    for (i=0 ; i<numsectors ; i++)
+	sectors[i].planesmoved = false;
+}
+
+
+//
+// AM_LineSeen
+//
+void AM_LineSeen(line_t* line)
+{
+    int		i;
+
+    if (!amlines)
+	return;
+
+    i = line - lines;
+    amlines[i].flags |= ML_MAPPED;
+    seenlines[numseen++] = i;
+}
+
+
+//
+// AM_drawAmline
+// Lines outside the window are dropped
+//  before any of the clipping.
+//
+void AM_drawAmline(amline_t* al, int color)
+{
+    if (al->bbox[BOXLEFT] > m_x2 || al->bbox[BOXRIGHT] < m_x
+	|| al->bbox[BOXBOTTOM] > m_y2 || al->bbox[BOXTOP] < m_y)
+	return;
+    AM_drawMline(&al->l, color);
+}
+
+
 void AM_drawWalls(void)
 {
-    int i;
-    static mline_t l;
+    int		i;
+    int		j;
+    int		color[NUMAMCLASSES];
+    sector_t*	sec;
+    amline_t*	al;
 
-    for (i=0;i<numlines;i++)
+    // heights that moved may change some colours
+    for (i=0, sec=sectors ; i<numsectors ; i++, sec++)
     {
-	l.a.x = lines[i].v1->x;
-	l.a.y = lines[i].v1->y;
-	l.b.x = lines[i].v2->x;
-	l.b.y = lines[i].v2->y;
-	if (cheating || (lines[i].flags & ML_MAPPED))
+	if (!sec->planesmoved)
+	    continue;
+	for (j=0 ; j<sec->linecount ; j++)
+	    AM_classifyLine(sec->lines[j] - lines);
+	sec->planesmoved = false;
+    }
+
+    color[amc_wall] = WALLCOLORS+lightlev;
+    color[amc_teleport] = WALLCOLORS+WALLRANGE/2;
+    color[amc_secret] = cheating ? SECRETWALLCOLORS+lightlev
+	: WALLCOLORS+lightlev;
+    color[amc_floor] = FDWALLCOLORS+lightlev;
+    color[amc_ceiling] = CDWALLCOLORS+lightlev;
+    color[amc_plain] = cheating ? TSWALLCOLORS+lightlev : -1;
+
+    if (!cheating && !plr->powers[pw_allmap])
+    {
+	// only what has been seen
+	for (i=0;i<numseen;i++)
 	{
-	    if ((lines[i].flags & LINE_NEVERSEE) && !cheating)
+	    j = seenlines[i];
+	    al = &amlines[j];
+	    if (al->flags & LINE_NEVERSEE)
 		continue;
-	    if (!lines[i].backsector)
-	    {
-		AM_drawMline(&l, WALLCOLORS+lightlev);
-	    }
-	    else
-	    {
-		if (lines[i].special == 39)
-		{ // teleporters
-		    AM_drawMline(&l, WALLCOLORS+WALLRANGE/2);
-		}
-		else if (lines[i].flags & ML_SECRET) // secret door
-		{
-		    if (cheating) AM_drawMline(&l, SECRETWALLCOLORS + lightlev);
-		    else AM_drawMline(&l, WALLCOLORS+lightlev);
-		}
-		else if (lines[i].backsector->floorheight
-			   != lines[i].frontsector->floorheight) {
-		    AM_drawMline(&l, FDWALLCOLORS + lightlev); // floor level change
-		}
-		else if (lines[i].backsector->ceilingheight
-			   != lines[i].frontsector->ceilingheight) {
-		    AM_drawMline(&l, CDWALLCOLORS+lightlev); // ceiling level change
-		}
-		else if (cheating) {
-		    AM_drawMline(&l, TSWALLCOLORS+lightlev);
-		}
-	    }
+	    // a walk over teleporter gets cleared when used
+	    if (al->amclass == amc_teleport && lines[j].special != 39)
+		AM_classifyLine(j);
+	    if (color[al->amclass] != -1)
+		AM_drawAmline(al, color[al->amclass]);
+	}
+	return;
+    }
+
+    for (i=0, al=amlines;i<numlines;i++, al++)
+    {
+	if (cheating || (al->flags & ML_MAPPED))
+	{
+	    if ((al->flags & LINE_NEVERSEE) && !cheating)
+		continue;
+	    if (al->amclass == amc_teleport && lines[i].special != 39)
+		AM_classifyLine(i);
+	    if (color[al->amclass] != -1)
+		AM_drawAmline(al, color[al->amclass]);
 	}
 	else if (plr->powers[pw_allmap])
 	{
-	    if (!(lines[i].flags & LINE_NEVERSEE)) AM_drawMline(&l, GRAYS+3);
+	    if (!(al->flags & LINE_NEVERSEE)) AM_drawAmline(al, GRAYS+3);
 	}
     }
 }
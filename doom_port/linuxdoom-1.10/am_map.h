@@ -22,6 +22,9 @@
 #ifndef __AMMAP_H__
 #define __AMMAP_H__
 
+#include "d_event.h"
+#include "r_defs.h"
+
 // Used by ST StatusBar stuff.
 #define AM_MSGHEADER (('a'<<24)+('m'<<16))
 #define AM_MSGENTERED (AM_MSGHEADER | ('e'<<8))
@@ -42,6 +45,13 @@ void AM_Drawer (void);
 // if the level is completed while it is up.
 void AM_Stop (void);
 
+// Called by P_SetupLevel and after loading a game,
+// builds the automap's copy of the lines.
+void AM_InitLines (void);
+
+// Called by the refresh when it sets ML_MAPPED.
+void AM_LineSeen (line_t* line);
+
 
 
 #endif
@@ -59,6 +59,7 @@ static const char rcsid[] = "$Id: d_main.c,v 1.8 1997/02/03 22:45:09 b1 Exp $";
 #include "m_argv.h"
 #include "m_misc.h"
 #include "m_menu.h"
+#include "m_prof.h"
 
 #include "i_system.h"
 #include "i_sound.h"
@@ -73,6 +74,8 @@ static const char rcsid[] = "$Id: d_main.c,v 1.8 1997/02/03 22:45:09 b1 Exp $";
 
 #include "p_setup.h"
 #include "r_local.h"
+#include "r_pvs.h"
+#include "r_snap.h"
 
 
 #include "d_main.h"
@@ -101,6 +104,9 @@ boolean         drone;
 
 boolean		singletics = false; // debug flag to cancel adaptiveness
 
+// draw as often as the display allows, interpolating between tics
+int		uncapped = 0;
+
 
 
 //extern int soundVolume;
@@ -179,6 +185,74 @@ void D_ProcessEvents (void)
 
 
 
+//
+// D_RenderView
+// Nothing moves while paused or in the menu (see P_Ticker),
+//  so once a couple of tics have gone by like that,
+//  the last view is put back instead of rendered again.
+//
+static byte	viewcache[SCREENWIDTH*SCREENHEIGHT];
+static boolean	viewcached;
+
+void D_RenderView (void)
+{
+    static int	frozentic = -1;
+    static int	cachedplayer;
+    boolean	frozen;
+    byte*	src;
+    byte*	dest;
+    int		y;
+
+    frozen = paused || (menuactive && !netgame && !demoplayback);
+    if (!frozen || cachedplayer != displayplayer)
+    {
+	frozentic = -1;
+	viewcached = false;
+    }
+    if (frozen && frozentic == -1)
+	frozentic = gametic;
+
+    if (viewcached)
+    {
+	src = viewcache;
+	dest = screens[0] + viewwindowy*SCREENWIDTH + viewwindowx;
+	for (y=0 ; y<scaledviewheight ; y++)
+	{
+	    memcpy (dest, src, scaledviewwidth);
+	    src += scaledviewwidth;
+	    dest += SCREENWIDTH;
+	}
+	V_MarkRect (viewwindowx, viewwindowy, scaledviewwidth, scaledviewheight);
+	return;
+    }
+
+    // how far to move things from their last tic positions
+    if (uncapped && !singletics)
+	fractionaltic = I_GetFracTime ();
+    else
+	fractionaltic = FRACUNIT;
+    if (pipeline)
+	R_RenderSnapshotView (&players[displayplayer]);
+    else
+	R_RenderPlayerView (&players[displayplayer]);
+
+    // the old positions have caught up by now
+    if (frozen && gametic > frozentic+1)
+    {
+	src = screens[0] + viewwindowy*SCREENWIDTH + viewwindowx;
+	dest = viewcache;
+	for (y=0 ; y<scaledviewheight ; y++)
+	{
+	    memcpy (dest, src, scaledviewwidth);
+	    src += SCREENWIDTH;
+	    dest += scaledviewwidth;
+	}
+	viewcached = true;
+	cachedplayer = displayplayer;
+    }
+}
+
+
 //
 // D_Display
 //  draw current display, possibly wiping it from the previous
@@ -208,6 +282,12 @@ void D_Display (void)
 
     if (nodrawers) // teheehee ANTON
 	return;                    // for comparative timing / profiling
+
+    // the view started last frame, if any
+    R_FinishSnapshot ();
+
+    // nobody holds a patch yet
+    R_DecodeWaitingPatches ();
 		
     redrawsbar = false;
     
@@ -217,12 +297,14 @@ void D_Display (void)
 	R_ExecuteSetViewSize ();
 	oldgamestate = (gamestate_t)-1;                      // force background redraw
 	borderdrawcount = 3;
+	viewcached = false;
     }
 
     // save the current screen if about to wipe
     if (gamestate != wipegamestate)
     {
 	wipe = true;
+	viewcached = false;
 	wipe_StartScreen(0, 0, SCREENWIDTH, SCREENHEIGHT);
     }
     else
@@ -239,12 +321,14 @@ void D_Display (void)
 	    break;
 	if (automapactive)
 	    AM_Drawer ();
-	if (wipe || (viewheight != 200 && fullscreen) )
+	if (wipe || (scaledviewheight != 200 && fullscreen) )
 	    redrawsbar = true;
 	if (inhelpscreensstate && !inhelpscreens)
 	    redrawsbar = true;              // just put away the help screen
-	ST_Drawer (viewheight == 200, redrawsbar );
-	fullscreen = viewheight == 200;
+	M_ProfBegin (prof_stbar);
+	ST_Drawer (scaledviewheight == 200, redrawsbar );
+	M_ProfEnd (prof_stbar);
+	fullscreen = scaledviewheight == 200;
 	break;
 
       case GS_INTERMISSION:
@@ -265,10 +349,14 @@ void D_Display (void)
     
     // draw the view directly
     if (gamestate == GS_LEVEL && !automapactive && gametic)
-	R_RenderPlayerView (&players[displayplayer]);
+	D_RenderView ();
 
     if (gamestate == GS_LEVEL && gametic)
+    {
+	M_ProfBegin (prof_hud);
 	HU_Drawer ();
+	M_ProfEnd (prof_hud);
+    }
     
     // clean up border stuff
     if (gamestate != oldgamestate && gamestate != GS_LEVEL)
@@ -313,13 +401,18 @@ void D_Display (void)
 
     // menus go directly to the screen
     M_Drawer ();          // menu is drawn even on top of everything
+    M_ProfDrawer ();      // and the profile numbers on top of that
     NetUpdate ();         // send out any new accumulation
 
 
     // normal update
     if (!wipe)
     {
+	R_StartSnapshot ();
+	M_ProfBegin (prof_blit);
 	I_FinishUpdate ();              // page flip or blit buffer
+	M_ProfEnd (prof_blit);
+	M_ProfFrame ();
 	return;
     }
     
@@ -363,6 +456,8 @@ void D_DoomLoop (void)
 	printf ("debug output to: %s\n",filename);
 	debugfile = fopen (filename,"w");
     }
+
+    M_ProfInit ();
 	
     I_InitGraphics ();
 
@@ -1015,6 +1110,20 @@ void D_DoomMain (void)
     printf ("M_LoadDefaults: Load system defaults.\n");
     M_LoadDefaults ();              // load before initing other systems
 
+    if (M_CheckParm ("-uncapped"))
+	uncapped = 1;
+
+    nopvs = M_CheckParm ("-nopvs");
+    floatrender = M_CheckParm ("-floatrender");
+    floatcompare = M_CheckParm ("-floatcompare");
+
+    p = M_CheckParm ("-rendertime");
+    if (p && p < myargc-1)
+	renderbudget = atof (myargv[p+1])*1000;
+
+    I_InitCPU ();
+    printf ("I_InitCPU: %s drawers.\n", cputiernames[cputier]);
+
     printf ("Z_Init: Init zone memory allocation daemon. \n");
     Z_Init ();
 
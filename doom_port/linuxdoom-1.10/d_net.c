@@ -674,7 +674,13 @@ void TryRunTics (void)
 	counts = availabletics;
     
     if (counts < 1)
+    {
+	// nothing new to run yet, so rather than wait
+	//  go draw another interpolated frame
+	if (uncapped && !singletics && availabletics < 1)
+	    return;
 	counts = 1;
+    }
 		
     frameon++;
 
@@ -730,6 +736,9 @@ void TryRunTics (void)
 	    M_Ticker ();
 	    return;
 	} 
+
+	if (lowtic < gametic/ticdup + counts)
+	    I_Sleep (1);
     }
     
     // run the count * ticdup dics
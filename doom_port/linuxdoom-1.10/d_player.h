@@ -163,6 +163,10 @@ typedef struct player_s
     // True if secret level has been done.
     boolean		didsecret;	
 
+    // viewz at the start of the current tic,
+    //  for refresh interpolation.
+    fixed_t		oldviewz;
+
 } player_t;
 
 
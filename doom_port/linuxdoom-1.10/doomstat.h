@@ -144,6 +144,7 @@ extern	int		viewwindowy;
 extern	int		viewheight;
 extern	int		viewwidth;
 extern	int		scaledviewwidth;
+extern	int		scaledviewheight;
 
 
 
@@ -183,6 +184,10 @@ extern  boolean	usergame;
 extern  boolean	demoplayback;
 extern  boolean	demorecording;
 
+// Set by G_DoPlayDemo while G_InitNew loads the first level,
+//  demoplayback is only set after that.
+extern  boolean	demoloading;
+
 // Quit after playing a demo from cmdline.
 extern  boolean		singledemo;	
 
@@ -257,6 +262,9 @@ extern  int             mouseSensitivity;
 // debug flag to cancel adaptiveness
 extern  boolean         singletics;	
 
+// refresh faster than the tic rate, interpolating
+extern  int             uncapped;
+
 extern  int             bodyqueslot;
 
 
@@ -47,28 +47,6 @@ static byte*	wipe_scr_end;
 static byte*	wipe_scr;
 
 
-void
-wipe_shittyColMajorXform
-( short*	array,
-  int		width,
-  int		height )
-{
-    int		x;
-    int		y;
-    short*	dest;
-
-    dest = (short*) Z_Malloc(width*height*2, PU_STATIC, 0);
-
-    for(y=0;y<height;y++)
-	for(x=0;x<width;x++)
-	    dest[x*height+y] = array[y*width+x];
-
-    memcpy(array, dest, width*height*2);
-
-    Z_Free(dest);
-
-}
-
 int
 wipe_initColorXForm
 ( int	width,
@@ -135,7 +113,10 @@ wipe_exitColorXForm
 }
 
 
+// Column positions, kept from one wipe to the next
+//  and only reallocated for a wider screen.
 static int*	y;
+static int	ywidth;
 
 int
 wipe_initMelt
@@ -148,14 +129,15 @@ wipe_initMelt
     // copy start screen to main screen
     memcpy(wipe_scr, wipe_scr_start, width*height);
     
-    // makes this wipe faster (in theory)
-    // to have stuff in column-major format
-    wipe_shittyColMajorXform((short*)wipe_scr_start, width/2, height);
-    wipe_shittyColMajorXform((short*)wipe_scr_end, width/2, height);
-    
     // setup initial column positions
     // (y<0 => not ready to scroll yet)
-    y = (int *) Z_Malloc(width*sizeof(int), PU_STATIC, 0);
+    if (width > ywidth)
+    {
+	if (y)
+	    Z_Free(y);
+	y = (int *) Z_Malloc(width*sizeof(int), PU_STATIC, 0);
+	ywidth = width;
+    }
     y[0] = -(M_Random()%16);
     for (i=1;i<width;i++)
     {
@@ -175,14 +157,17 @@ wipe_doMelt
   int	ticks )
 {
     int		i;
-    int		j;
+    int		r;
     int		dy;
-    int		idx;
+    int		top;
+    int		low;
     
     short*	s;
+    short*	e;
     short*	d;
     boolean	done = true;
 
+    // two pixels per column
     width/=2;
 
     while (ticks--)
@@ -197,28 +182,45 @@ wipe_doMelt
 	    {
 		dy = (y[i] < 16) ? y[i]+1 : 8;
 		if (y[i]+dy >= height) dy = height - y[i];
-		s = &((short *)wipe_scr_end)[i*height+y[i]];
-		d = &((short *)wipe_scr)[y[i]*width+i];
-		idx = 0;
-		for (j=dy;j;j--)
-		{
-		    d[idx] = *(s++);
-		    idx += width;
-		}
 		y[i] += dy;
-		s = &((short *)wipe_scr_start)[i*height];
-		d = &((short *)wipe_scr)[y[i]*width+i];
-		idx = 0;
-		for (j=height-y[i];j;j--)
-		{
-		    d[idx] = *(s++);
-		    idx += width;
-		}
 		done = false;
 	    }
 	}
     }
 
+    if (done)
+	return done;
+
+    // Above its y a column shows the end screen,
+    //  below it the start screen pushed down by y.
+    // Straight from both row major screens, a row at a time,
+    //  no column major copies and no strided writes.
+    low = height;
+    for (i=0;i<width;i++)
+	if (y[i] < low)
+	    low = y[i];
+    if (low < 0)
+	low = 0;
+
+    s = (short *)wipe_scr_start;
+    e = (short *)wipe_scr_end;
+    d = (short *)wipe_scr;
+
+    // rows every column has melted past
+    memcpy(d, e, low*width*2);
+
+    for (r=low;r<height;r++)
+    {
+	for (i=0;i<width;i++)
+	{
+	    top = y[i] > 0 ? y[i] : 0;
+	    if (r < top)
+		d[r*width+i] = e[r*width+i];
+	    else
+		d[r*width+i] = s[(r-top)*width+i];
+	}
+    }
+
     return done;
 
 }
@@ -229,7 +231,6 @@ wipe_exitMelt
   int	height,
   int	ticks )
 {
-    Z_Free(y);
     return 0;
 }
 
@@ -65,6 +65,7 @@ rcsid[] = "$Id: g_game.c,v 1.8 1997/02/03 22:45:09 b1 Exp $";
 // SKY handling - still the wrong place.
 #include "r_data.h"
 #include "r_sky.h"
+#include "r_snap.h"
 
 
 
@@ -127,6 +128,7 @@ int             totalkills, totalitems, totalsecret;    // for intermission
 char            demoname[32]; 
 boolean         demorecording; 
 boolean         demoplayback; 
+boolean		demoloading;
 boolean		netdemo; 
 byte*		demobuffer;
 byte*		demo_p;
@@ -613,6 +615,10 @@ void G_Ticker (void)
 	if (playeringame[i] && players[i].playerstate == PST_REBORN) 
 	    G_DoReborn (i);
     
+    // a level load frees what the view is drawn from
+    if (gameaction != ga_nothing)
+	R_FinishSnapshot ();
+
     // do things to change the game state
     while (gameaction != ga_nothing) 
     { 
@@ -1029,6 +1035,8 @@ void G_DoCompleted (void)
 	 
     if (automapactive) 
 	AM_Stop (); 
+
+    P_ReportSight ();
 	
     if ( gamemode != commercial)
 	switch(gamemap)
@@ -1197,6 +1205,10 @@ void G_LoadGame (char* name)
  
 #define VERSIONSIZE		16 
 
+// Saves hold mobj_t and player_t as they are in memory,
+//  so this goes up whenever either of them changes.
+#define SAVEVERSION		3
+
 
 void G_DoLoadGame (void) 
 { 
@@ -1212,7 +1224,7 @@ void G_DoLoadGame (void)
     
     // skip the description field 
     memset (vcheck,0,sizeof(vcheck)); 
-    sprintf (vcheck,"version %i",VERSION); 
+    sprintf (vcheck,"version %i.%i",VERSION,SAVEVERSION); 
     if (strcmp ((const char*)save_p, vcheck)) 
 	return;				// bad version 
     save_p += VERSIONSIZE; 
@@ -1286,7 +1298,7 @@ void G_DoSaveGame (void)
     memcpy (save_p, description, SAVESTRINGSIZE); 
     save_p += SAVESTRINGSIZE; 
     memset (name2,0,sizeof(name2)); 
-    sprintf (name2,"version %i",VERSION); 
+    sprintf (name2,"version %i.%i",VERSION,SAVEVERSION); 
     memcpy (save_p, name2, VERSIONSIZE); 
     save_p += VERSIONSIZE; 
 	 
@@ -1617,7 +1629,9 @@ void G_DoPlayDemo (void)
 
     // don't spend a lot of time in loadlevel 
     precache = false;
+    demoloading = true;
     G_InitNew (skill, episode, map); 
+    demoloading = false;
     precache = true; 
 
     usergame = false; 
@@ -1653,6 +1667,9 @@ boolean G_CheckDemoStatus (void)
 { 
     int             endtime; 
 	 
+    // the level the demo ended on
+    P_ReportSight ();
+
     if (timingdemo) 
     { 
 	endtime = I_GetTime (); 
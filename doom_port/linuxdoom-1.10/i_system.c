@@ -30,10 +30,12 @@ rcsid[] = "$Id: m_bbox.c,v 1.1 1997/02/03 22:45:10 b1 Exp $";
 
 #include <stdarg.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "doomdef.h"
 #include "m_misc.h"
+#include "m_argv.h"
 #include "i_video.h"
 #include "i_sound.h"
 
@@ -50,6 +52,9 @@ rcsid[] = "$Id: m_bbox.c,v 1.1 1997/02/03 22:45:10 b1 Exp $";
 
 int	mb_used = 6;
 
+cputier_t	cputier;
+char*		cputiernames[NUMCPUTIERS] = { "scalar", "sse2", "avx2" };
+
 
 void
 I_Tactile
@@ -76,7 +81,51 @@ int  I_GetHeapSize (void)
 byte* I_ZoneBase (int*	size)
 {
     *size = mb_used*1024*1024;
-    return (byte *) malloc (*size);
+
+    // The AVX2 drawers gather four bytes for every one they use,
+    //  so the last block can be read a little past its end.
+    return (byte *) malloc (*size + 4);
+}
+
+
+//
+// I_InitCPU
+// Probes the processor once.
+// -cpu scalar|sse2|avx2 forces a tier, for benchmarking,
+//  as long as the processor has it.
+//
+void I_InitCPU (void)
+{
+    cputier_t	best;
+    int		p;
+    int		i;
+
+    best = cpu_scalar;
+#ifdef CPU_X86
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("sse2"))
+    {
+	best = cpu_sse2;
+	// also checks that the OS saves the ymm registers
+	if (__builtin_cpu_supports ("avx2"))
+	    best = cpu_avx2;
+    }
+#endif
+    cputier = best;
+
+    p = M_CheckParm ("-cpu");
+    if (p && p < myargc-1)
+    {
+	for (i=0 ; i<NUMCPUTIERS ; i++)
+	    if (!strcasecmp (myargv[p+1], cputiernames[i]))
+		break;
+	if (i == NUMCPUTIERS)
+	    printf ("I_InitCPU: unknown tier %s\n", myargv[p+1]);
+	else if (i > best)
+	    printf ("I_InitCPU: no %s on this processor\n", cputiernames[i]);
+	else
+	    cputier = i;
+    }
 }
 
 
@@ -85,12 +134,13 @@ byte* I_ZoneBase (int*	size)
 // I_GetTime
 // returns time in 1/70th second tics
 //
+static int	basetime=0;
+
 int  I_GetTime (void)
 {
     struct timeval	tp;
     struct timezone	tzp;
     int			newtics;
-    static int		basetime=0;
   
     gettimeofday(&tp, &tzp);
     if (!basetime)
@@ -100,6 +150,35 @@ int  I_GetTime (void)
 }
 
 
+//
+// I_GetTimeUS
+// returns a microsecond clock for profiling,
+//  it wraps, only use differences
+//
+unsigned I_GetTimeUS (void)
+{
+    struct timespec	ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+
+//
+// I_GetFracTime
+// returns how far we are into the current tic,
+//  0 to FRACUNIT, on the same clock as I_GetTime
+//
+fixed_t I_GetFracTime (void)
+{
+    struct timeval	tp;
+    struct timezone	tzp;
+  
+    gettimeofday(&tp, &tzp);
+    return FixedDiv ((tp.tv_usec*TICRATE) % 1000000, 1000000);
+}
+
+
 
 //
 // I_Init
@@ -123,6 +202,14 @@ void I_Quit (void)
     exit(0);
 }
 
+//
+// I_Sleep
+//
+void I_Sleep (int ms)
+{
+    usleep (ms*1000);
+}
+
 void I_WaitVBL(int count)
 {
 #ifdef SGI
@@ -25,12 +25,36 @@
 
 #include "d_ticcmd.h"
 #include "d_event.h"
+#include "m_fixed.h"
 
 #ifdef __GNUG__
 #pragma interface
 #endif
 
 
+// The faster drawers are built with gcc's target attributes,
+//  so nothing else needs special compiler flags.
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define CPU_X86
+#endif
+
+typedef enum
+{
+    cpu_scalar,
+    cpu_sse2,
+    cpu_avx2,
+    NUMCPUTIERS
+
+} cputier_t;
+
+// Best drawers this processor can run,
+//  or what -cpu asked for.
+extern cputier_t	cputier;
+extern char*		cputiernames[NUMCPUTIERS];
+
+// Called by DoomMain before R_Init.
+void I_InitCPU (void);
+
 // Called by DoomMain.
 void I_Init (void);
 
@@ -44,6 +68,17 @@ byte*	I_ZoneBase (int *size);
 // returns current time in tics.
 int I_GetTime (void);
 
+// Microsecond timer for profiling.
+unsigned I_GetTimeUS (void);
+
+// Give the CPU away while waiting for a tic.
+void I_Sleep (int ms);
+
+// Called by D_Display,
+// returns the fraction of the current tic
+// that has elapsed, for interpolated refresh.
+fixed_t I_GetFracTime (void);
+
 
 //
 // Called by D_DoomLoop,
@@ -60,7 +60,9 @@ rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 
 #include "doomstat.h"
 #include "i_system.h"
+#include "i_video.h"
 #include "v_video.h"
+#include "m_bbox.h"
 #include "m_argv.h"
 #include "d_main.h"
 
@@ -78,7 +80,8 @@ rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 	GLuint quad_sp;
 	GLuint quad_tex;
 	unsigned char image_data[320 * 200];
-	unsigned char corrected[320 * 200 * 3];
+	// the wide converters store a little past the last pixel
+	unsigned char corrected[320 * 200 * 3 + 16];
 	int g_gl_width = 800;
 	int g_gl_height = 500;
 	int g_fullscreen;
@@ -88,6 +91,11 @@ rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 	char p_red[256];
 	char p_green[256];
 	char p_blue[256];
+	// the same palette as 0x00bbggrr words
+	unsigned palette32[256];
+	boolean palettechanged = true;
+	// exposed or restored, what was presented is gone
+	boolean windowdamaged = false;
 #else
 Display*	X_display=0;
 Window		X_mainWindow;
@@ -575,6 +583,18 @@ void I_UpdateNoBlit (void)
 
 #ifdef ANTON
 #ifdef GLFW
+// Expose and restore, the next I_FinishUpdate presents
+// the whole frame even if nothing in it changed.
+void I_WindowRefresh (GLFWwindow* window) {
+	windowdamaged = true;
+}
+
+void I_WindowIconify (GLFWwindow* window, int iconified) {
+	if (!iconified) {
+		windowdamaged = true;
+	}
+}
+
 double previous_seconds = 0.0;
 int frame_count = 0;
 void _update_fps_counter (GLFWwindow* window) {
@@ -593,6 +613,91 @@ void _update_fps_counter (GLFWwindow* window) {
 	}
 	frame_count++;
 }
+
+
+//
+// Palette to RGB conversion for the upload,
+//  picked by I_InitGraphics from cputier.
+//
+void (*I_ConvertRows) (byte* src, byte* dest, int count);
+
+void I_ConvertRowsScalar (byte* src, byte* dest, int count) {
+	while (count--) {
+		int v = *src++;
+		*dest++ = p_red[v];
+		*dest++ = p_green[v];
+		*dest++ = p_blue[v];
+	}
+}
+
+// One word store per pixel, each overlapping the last
+// by a byte.
+void I_ConvertRowsWords (byte* src, byte* dest, int count) {
+	while (count--) {
+		memcpy (dest, &palette32[*src++], 4);
+		dest += 3;
+	}
+}
+
+#ifdef CPU_X86
+#include <immintrin.h>
+
+// Four pixels a step, packed from four bytes each to
+// three with shifts and masks, SSE2 having no byte shuffle.
+// The store runs four bytes past the pixels, which the
+// next step writes over, so it stops with two steps left.
+__attribute__ ((target ("sse2")))
+void I_ConvertRowsSSE2 (byte* src, byte* dest, int count) {
+	__m128i low;
+	__m128i high;
+	__m128i first;
+	__m128i second;
+	__m128i v;
+	__m128i t;
+
+	// per half: the first pixel's three bytes, then the second's
+	low = _mm_set_epi32 (0, 0x00ffffff, 0, 0x00ffffff);
+	high = _mm_set_epi32 (0x0000ffff, 0xff000000, 0x0000ffff, 0xff000000);
+	// the halves' six bytes each, closed up
+	first = _mm_set_epi32 (0, 0, 0x0000ffff, 0xffffffff);
+	second = _mm_set_epi32 (0, 0xffffffff, 0xffff0000, 0);
+	for ( ; count >= 8; count -= 4) {
+		v = _mm_setr_epi32 (palette32[src[0]], palette32[src[1]],
+				    palette32[src[2]], palette32[src[3]]);
+		t = _mm_or_si128 (_mm_and_si128 (v, low),
+				  _mm_and_si128 (_mm_srli_epi64 (v, 8), high));
+		t = _mm_or_si128 (_mm_and_si128 (t, first),
+				  _mm_and_si128 (_mm_srli_si128 (t, 2), second));
+		_mm_storeu_si128 ((__m128i *)dest, t);
+		src += 4;
+		dest += 12;
+	}
+	I_ConvertRowsWords (src, dest, count);
+}
+
+// Eight pixels with one gather, each half shuffled down to
+// twelve bytes.
+__attribute__ ((target ("avx2")))
+void I_ConvertRowsAVX2 (byte* src, byte* dest, int count) {
+	__m256i shuffle;
+	__m256i v;
+	
+	shuffle = _mm256_setr_epi8 (
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+	);
+	for ( ; count >= 8; count -= 8) {
+		v = _mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((__m128i *)src));
+		v = _mm256_i32gather_epi32 ((int const *)palette32, v, 4);
+		v = _mm256_shuffle_epi8 (v, shuffle);
+		_mm_storeu_si128 ((__m128i *)dest, _mm256_castsi256_si128 (v));
+		_mm_storeu_si128 ((__m128i *)(dest + 12), _mm256_extracti128_si256 (v, 1));
+		src += 8;
+		dest += 24;
+	}
+	I_ConvertRowsWords (src, dest, count);
+}
+#endif
 #endif
 #endif
 
@@ -620,6 +725,7 @@ void I_FinishUpdate (void)
 	    screens[0][ (SCREENHEIGHT-1)*SCREENWIDTH + i] = 0xff;
 	for ( ; i<20*2 ; i+=2)
 	    screens[0][ (SCREENHEIGHT-1)*SCREENWIDTH + i] = 0x0;
+	V_MarkRect (0, SCREENHEIGHT-1, 20*2, 1);
     
     }
 
@@ -747,51 +853,80 @@ void I_FinishUpdate (void)
 #ifdef ANTON
 	#ifdef GLFW
 	
-		int c_i = 0;
-		int id;
-		for (id = 0; id < 320 * 200; id++) {
-			int v = (int)image_data[id];
-			char r = p_red[v];
-			char g = p_green[v];
-			char b = p_blue[v];
-			corrected[c_i++] = r;
-			corrected[c_i++] = g;
-			corrected[c_i++] = b;
+		// Only rows inside the dirty box can have changed since the
+		// last frame, and only those that really did get converted
+		// and uploaded. Nothing at all means no upload and no swap.
+		static byte lastframe[320 * 200];
+		int top = 200;
+		int bottom = -1;
+		int y;
+		if (palettechanged || windowdamaged) {
+			top = 0;
+			bottom = 199;
+			memcpy (lastframe, image_data, 320 * 200);
+			palettechanged = false;
+			windowdamaged = false;
+		} else if (dirtybox[BOXTOP] >= dirtybox[BOXBOTTOM]) {
+			int first = dirtybox[BOXBOTTOM] < 0 ? 0 : dirtybox[BOXBOTTOM];
+			int last = dirtybox[BOXTOP] > 199 ? 199 : dirtybox[BOXTOP];
+			for (y = first; y <= last; y++) {
+				if (memcmp (&lastframe[y * 320], &image_data[y * 320], 320)) {
+					memcpy (&lastframe[y * 320], &image_data[y * 320], 320);
+					if (y < top) {
+						top = y;
+					}
+					bottom = y;
+				}
+			}
 		}
+		M_ClearBox (dirtybox);
 		
-		// avoid any read-write during drawing (shouldn't happen)
-		glFlush ();
-		glFinish ();
-		glBindTexture (GL_TEXTURE_2D, quad_tex);
-		glTexImage2D (
-			GL_TEXTURE_2D,
-			0,
-			GL_RGB,
-			X_width,
-			X_height,
-			0,
-			GL_RGB,
-			GL_UNSIGNED_BYTE,
-			corrected
-		);
-		// avoid any read-write during drawing (shouldn't happen)
-		glFlush ();
-		glFinish ();
-	
-		_update_fps_counter (window);
-		
-		//glViewport (0, 0, 320, 200);
-		glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		
-		glUseProgram (quad_sp);
-		glBindVertexArray (quad_vao);
-		
-		glDrawArrays (GL_TRIANGLE_STRIP, 0, 4);
+		if (top <= bottom) {
+			I_ConvertRows (
+				&image_data[top * 320],
+				&corrected[top * 320 * 3],
+				(bottom - top + 1) * 320
+			);
+			
+			// avoid any read-write during drawing (shouldn't happen)
+			glFlush ();
+			glFinish ();
+			glBindTexture (GL_TEXTURE_2D, quad_tex);
+			glTexSubImage2D (
+				GL_TEXTURE_2D,
+				0,
+				0,
+				top,
+				X_width,
+				bottom - top + 1,
+				GL_RGB,
+				GL_UNSIGNED_BYTE,
+				&corrected[top * 320 * 3]
+			);
+			// avoid any read-write during drawing (shouldn't happen)
+			glFlush ();
+			glFinish ();
 		
-		/* update other events like input handling */
-		glfwPollEvents ();
-		/* put the stuff we've been drawing onto the display */
-		glfwSwapBuffers (window);
+			_update_fps_counter (window);
+			
+			//glViewport (0, 0, 320, 200);
+			glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			
+			glUseProgram (quad_sp);
+			glBindVertexArray (quad_vao);
+			
+			glDrawArrays (GL_TRIANGLE_STRIP, 0, 4);
+			
+			/* update other events like input handling */
+			glfwPollEvents ();
+			/* put the stuff we've been drawing onto the display */
+			glfwSwapBuffers (window);
+		} else {
+			// same picture as last time, just wait as long as
+			// the swap would have
+			glfwPollEvents ();
+			I_WaitVBL (1);
+		}
 		
 		if (glfwWindowShouldClose (window)) {
 			glfwTerminate ();
@@ -912,7 +1047,10 @@ void I_SetPalette (byte* palette)
 		p_green[i] = (c<<8) + c;
 		c = gammatable[usegamma][*palette++];
 		p_blue[i] = (c<<8) + c;
+		palette32[i] = (byte)p_red[i] | ((byte)p_green[i] << 8)
+			| ((byte)p_blue[i] << 16);
 	}
+	palettechanged = true;
 #else
     UploadNewPalette(X_cmap, palette);
 #endif
@@ -1107,9 +1245,43 @@ void I_InitGraphics(void)
 				"-fs\t\t\tfull-screen\n"
 				"-res WIDTH HEIGHT\tspecify resolution. default 800x500\n"
 				"-aa\t\t\tenables post-process anti-aliasing\n"
+				"-uncapped\t\tdraw between tics, interpolated\n"
+				"-profile\t\tshow refresh timings\n"
+				"-profcsv FILE\t\twrite refresh timings per frame\n"
+				"-nopvs\t\t\tdon't cull the BSP walk by sector visibility\n"
+				"-cpu scalar|sse2|avx2\tforce the drawers used\n"
+				"-floatrender\t\tproject the view in float\n"
+				"-floatcompare\t\tdraw fixed and float, count the\n"
+				"\t\t\tdiffering pixels (with -profile)\n"
+				"-rendertime MS\t\tlower the view resolution to hold\n"
+				"\t\t\tthe view's render time under MS\n"
+				"-multiview\t\talso draw every other player's view\n"
+				"-rthreads N\t\tthreads drawing views, default one\n"
+				"\t\t\tper processor\n"
+				"-pipeline\t\tdraw the view on another thread\n"
+				"\t\t\twhile the next tics run\n"
+				"-litcache [KB]\t\tkeep the most drawn walls lit,\n"
+				"\t\t\tdefault 2048KB, outside the zone\n"
+				"-mipmap\t\t\tdraw far walls and flats from\n"
+				"\t\t\tsmaller, averaged copies\n"
+				"-benchdrawers\t\ttime the processor drawers\n"
+				"\t\t\tagainst the C ones at startup\n"
+				"-globalthinkers\t\trun thinkers in the order added,\n"
+				"\t\t\tas demos and netgames always do\n"
+				"-nothinggrid\t\tcheck moves against every thing\n"
+				"\t\t\tin the blocks, not just nearby cells\n"
 			);
 			exit (0);
 		}
+		I_ConvertRows = I_ConvertRowsScalar;
+		#ifdef CPU_X86
+		if (cputier >= cpu_sse2) {
+			I_ConvertRows = I_ConvertRowsSSE2;
+		}
+		if (cputier >= cpu_avx2) {
+			I_ConvertRows = I_ConvertRowsAVX2;
+		}
+		#endif
 		pa = M_CheckParm ("-fs");
 		if (pa > 0) {
 			g_fullscreen = 1;
@@ -1157,6 +1329,8 @@ void I_InitGraphics(void)
 		
 		glfwSwapInterval (1);
 		glViewport (0, 0, g_gl_width, g_gl_height);
+		glfwSetWindowRefreshCallback (window, I_WindowRefresh);
+		glfwSetWindowIconifyCallback (window, I_WindowIconify);
 		
 		if (g_fullscreen) {
 			glfwSetInputMode (window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
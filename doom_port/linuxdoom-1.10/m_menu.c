@@ -50,6 +50,7 @@ rcsid[] = "$Id: m_menu.c,v 1.7 1997/02/03 22:45:10 b1 Exp $";
 #include "hu_stuff.h"
 
 #include "g_game.h"
+#include "p_setup.h"
 
 #include "m_argv.h"
 #include "m_swap.h"
@@ -1089,6 +1090,7 @@ void M_QuitResponse(int ch)
 	    S_StartSound(NULL,quitsounds[(gametic>>2)&7]);
 	I_WaitVBL(105);
     }
+    P_ReportSight ();
     I_Quit ();
 }
 
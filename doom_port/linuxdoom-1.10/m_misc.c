@@ -204,6 +204,8 @@ extern int	screenblocks;
 
 extern int	showMessages;
 
+extern int	uncapped;
+
 // machine-independent sound params
 extern	int	numChannels;
 
@@ -279,6 +281,7 @@ default_t	defaults[] =
 
     {"screenblocks",&screenblocks, 9},
     {"detaillevel",&detailLevel, 0},
+    {"uncapped",&uncapped, 0},
 
     {"snd_channels",&numChannels, 3},
 
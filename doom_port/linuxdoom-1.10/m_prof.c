@@ -0,0 +1,297 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Refresh profiling.
+//	Phase timers use the microsecond clock,
+//	 counters come straight from the refresh.
+//	Cache misses come from the Linux perf_event counters.
+//
+//-----------------------------------------------------------------------------
+
+static const char
+rcsid[] = "$Id:$";
+
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef LINUX
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "doomdef.h"
+#include "doomstat.h"
+
+#include "i_system.h"
+#include "m_argv.h"
+#include "m_misc.h"
+
+#include "r_local.h"
+#include "r_state.h"
+
+#ifdef __GNUG__
+#pragma implementation "m_prof.h"
+#endif
+#include "m_prof.h"
+
+
+// Overlay shows averages over this many frames.
+#define PROFAVERAGE	32
+
+boolean		profiling;
+
+static boolean	profoverlay;
+static FILE*	profcsv;
+static int	profframe;
+static int	perffd = -1;
+static unsigned	bspmisses;
+
+// this frame
+static unsigned	phasestart[NUMPROFPHASES];
+static unsigned	phasetime[NUMPROFPHASES];
+static int	counts[NUMPROFCOUNTERS];
+
+// running sums, and the averages on display
+static unsigned	phasesum[NUMPROFPHASES];
+static int	countsum[NUMPROFCOUNTERS];
+static unsigned	phaseavg[NUMPROFPHASES];
+static int	countavg[NUMPROFCOUNTERS];
+
+static char*	phasenames[NUMPROFPHASES] =
+{
+    "bsp", "planes", "masked", "hud", "stbar", "blit"
+};
+
+static char*	countnames[NUMPROFCOUNTERS] =
+{
+    "sscount", "segs", "visplanes", "vissprites", "colpixels", "spanpixels",
+    "bspmisses", "sightmisses", "floatdiffs", "lithits", "litmisses",
+    "litkb", "sighthits"
+};
+
+
+//
+// M_ProfOpenMisses
+// Count last level cache misses of this process,
+//  user space only.
+//
+static void M_ProfOpenMisses (void)
+{
+#ifdef LINUX
+    struct perf_event_attr	attr;
+
+    memset (&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    perffd = syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    if (perffd == -1)
+	printf ("M_ProfInit: no cache miss counter\n");
+}
+
+
+//
+// M_ProfMisses
+//
+unsigned M_ProfMisses (void)
+{
+#ifdef LINUX
+    unsigned long long	count;
+
+    if (perffd != -1
+	&& read (perffd, &count, sizeof(count)) == sizeof(count))
+	return (unsigned)count;
+#endif
+    return 0;
+}
+
+
+//
+// M_ProfCount
+//
+void M_ProfCount (profcounter_t counter, int amount)
+{
+    counts[counter] += amount;
+}
+
+
+//
+// M_ProfInit
+//
+void M_ProfInit (void)
+{
+    int		p;
+    int		i;
+
+    if (M_CheckParm ("-profile"))
+	profoverlay = true;
+
+    p = M_CheckParm ("-profcsv");
+    if (p && p < myargc-1)
+    {
+	profcsv = fopen (myargv[p+1], "w");
+	if (!profcsv)
+	    I_Error ("M_ProfInit: couldn't open %s", myargv[p+1]);
+	printf ("profile output to: %s\n", myargv[p+1]);
+
+	fprintf (profcsv, "frame,gametic");
+	for (i=0 ; i<NUMPROFPHASES ; i++)
+	    fprintf (profcsv, ",%s_us", phasenames[i]);
+	for (i=0 ; i<NUMPROFCOUNTERS ; i++)
+	    fprintf (profcsv, ",%s", countnames[i]);
+	fprintf (profcsv, "\n");
+    }
+
+    profiling = profoverlay || profcsv;
+    if (profiling)
+	M_ProfOpenMisses ();
+}
+
+
+//
+// M_ProfBegin
+// M_ProfEnd
+// A phase may run more than once a frame,
+//  the times add up.
+//
+void M_ProfBegin (profphase_t phase)
+{
+    if (!profiling)
+	return;
+    phasestart[phase] = I_GetTimeUS ();
+    if (phase == prof_bsp)
+	bspmisses = M_ProfMisses ();
+}
+
+void M_ProfEnd (profphase_t phase)
+{
+    if (!profiling)
+	return;
+    phasetime[phase] += I_GetTimeUS () - phasestart[phase];
+    if (phase == prof_bsp)
+	counts[pc_bspmisses] += M_ProfMisses () - bspmisses;
+}
+
+
+//
+// M_ProfView
+// Snapshot the refresh counters, they
+//  are reset by the next R_SetupFrame.
+//
+void M_ProfView (void)
+{
+    if (!profiling)
+	return;
+
+    counts[pc_subsectors] = sscount;
+    counts[pc_segs] = linecount;
+    counts[pc_visplanes] = lastvisplane - visplanes;
+    counts[pc_vissprites] = vissprite_p - vissprites;
+    counts[pc_colpixels] = dccount;
+    counts[pc_spanpixels] = dscount;
+}
+
+
+//
+// M_ProfDrawer
+//
+void M_ProfDrawer (void)
+{
+    char	buf[40];
+    int		i;
+    int		y;
+    unsigned	total;
+
+    if (!profoverlay)
+	return;
+
+    y = 2;
+    total = 0;
+    for (i=0 ; i<NUMPROFPHASES ; i++)
+    {
+	sprintf (buf, "%s %u", phasenames[i], phaseavg[i]);
+	M_DrawText (2, y, false, buf);
+	total += phaseavg[i];
+	y += 8;
+    }
+    sprintf (buf, "total %u", total);
+    M_DrawText (2, y, false, buf);
+    y += 12;
+
+    for (i=0 ; i<NUMPROFCOUNTERS ; i++)
+    {
+	sprintf (buf, "%s %i", countnames[i], countavg[i]);
+	M_DrawText (2, y, false, buf);
+	y += 8;
+    }
+}
+
+
+//
+// M_ProfFrame
+//
+void M_ProfFrame (void)
+{
+    int		i;
+
+    if (!profiling)
+	return;
+
+    if (profcsv)
+    {
+	fprintf (profcsv, "%i,%i", profframe, gametic);
+	for (i=0 ; i<NUMPROFPHASES ; i++)
+	    fprintf (profcsv, ",%u", phasetime[i]);
+	for (i=0 ; i<NUMPROFCOUNTERS ; i++)
+	    fprintf (profcsv, ",%i", counts[i]);
+	fprintf (profcsv, "\n");
+    }
+
+    for (i=0 ; i<NUMPROFPHASES ; i++)
+    {
+	phasesum[i] += phasetime[i];
+	phasetime[i] = 0;
+    }
+    for (i=0 ; i<NUMPROFCOUNTERS ; i++)
+    {
+	countsum[i] += counts[i];
+	counts[i] = 0;
+    }
+
+    if (++profframe % PROFAVERAGE)
+	return;
+
+    // new averages for the overlay
+    for (i=0 ; i<NUMPROFPHASES ; i++)
+    {
+	phaseavg[i] = phasesum[i] / PROFAVERAGE;
+	phasesum[i] = 0;
+    }
+    for (i=0 ; i<NUMPROFCOUNTERS ; i++)
+    {
+	countavg[i] = countsum[i] / PROFAVERAGE;
+	countsum[i] = 0;
+    }
+}
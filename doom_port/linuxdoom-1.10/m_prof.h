@@ -0,0 +1,97 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Per frame timing of the refresh phases,
+//	 on-screen overlay and CSV dump.
+//    
+//-----------------------------------------------------------------------------
+
+
+#ifndef __M_PROF__
+#define __M_PROF__
+
+
+#include "doomtype.h"
+
+
+// Timed parts of a frame.
+typedef enum
+{
+    prof_bsp,		// R_RenderBSPNode, walls are drawn in here
+    prof_planes,	// R_DrawPlanes
+    prof_masked,	// R_DrawMasked
+    prof_hud,		// HU_Drawer
+    prof_stbar,		// ST_Drawer
+    prof_blit,		// I_FinishUpdate
+    NUMPROFPHASES
+    
+} profphase_t;
+
+
+// Refresh counters, snapshot after each view.
+typedef enum
+{
+    pc_subsectors,	// sscount
+    pc_segs,		// linecount, segs passed to R_StoreWallRange
+    pc_visplanes,
+    pc_vissprites,
+    pc_colpixels,	// dccount
+    pc_spanpixels,	// dscount
+    pc_bspmisses,	// cache misses in R_RenderBSPNode
+    pc_sightmisses,	// cache misses in P_CrossBSPNode
+    pc_floatdiffs,	// pixels -floatcompare found different
+    pc_lithits,		// wall columns drawn from the lit cache
+    pc_litmisses,	// and not
+    pc_litkb,		// lit cache size
+    pc_sighthits,	// P_CheckSight answered from the sight cache
+    NUMPROFCOUNTERS
+    
+} profcounter_t;
+
+
+// True if -profile or -profcsv was given.
+extern boolean	profiling;
+
+
+// Called by D_DoomLoop, reads the command line.
+void M_ProfInit (void);
+
+void M_ProfBegin (profphase_t phase);
+void M_ProfEnd (profphase_t phase);
+
+// Called by R_RenderPlayerView once the view is done.
+void M_ProfView (void);
+
+// Running count of CPU cache misses,
+//  0 when the hardware counter isn't available.
+unsigned M_ProfMisses (void);
+void M_ProfCount (profcounter_t counter, int amount);
+
+// Called by D_Display, draws the overlay.
+void M_ProfDrawer (void);
+
+// Called by D_Display after the blit,
+//  writes the CSV line and starts a new frame.
+void M_ProfFrame (void);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
@@ -502,36 +502,41 @@ P_LookForPlayers
 {
     int		c;
     int		stop;
+    int		look;
     player_t*	player;
-    sector_t*	sector;
     angle_t	an;
     fixed_t	dist;
-		
-    sector = actor->subsector->sector;
-	
+    mobj_t*	lookers[MAXPLAYERS];
+    mobj_t*	targets[MAXPLAYERS];
+    int		looks[MAXPLAYERS];
+    boolean	seen[MAXPLAYERS];
+    int		count;
+    int		i;
+
+    // Go round as always, but only collect the players
+    //  in view, their sight lines are checked together.
+    // The view test has no side effects, it can go first.
     c = 0;
+    count = 0;
     stop = (actor->lastlook-1)&3;
 	
-    for ( ; ; actor->lastlook = (actor->lastlook+1)&3 )
+    for (look = actor->lastlook ; ; look = (look+1)&3 )
     {
-	if (!playeringame[actor->lastlook])
+	if (!playeringame[look])
 	    continue;
 			
 	if (c++ == 2
-	    || actor->lastlook == stop)
+	    || look == stop)
 	{
 	    // done looking
-	    return false;	
+	    break;
 	}
 	
-	player = &players[actor->lastlook];
+	player = &players[look];
 
 	if (player->health <= 0)
 	    continue;		// dead
 
-	if (!P_CheckSight (actor, player->mo))
-	    continue;		// out of sight
-			
 	if (!allaround)
 	{
 	    an = R_PointToAngle2 (actor->x,
@@ -549,11 +554,27 @@ P_LookForPlayers
 		    continue;	// behind back
 	    }
 	}
-		
-	actor->target = player->mo;
-	return true;
+
+	lookers[count] = actor;
+	targets[count] = player->mo;
+	looks[count] = look;
+	count++;
+    }
+
+    P_CheckSights (lookers, targets, count, seen);
+
+    // the first one seen stops the look
+    for (i=0 ; i<count ; i++)
+    {
+	if (seen[i])
+	{
+	    actor->lastlook = looks[i];
+	    actor->target = targets[i];
+	    return true;
+	}
     }
 
+    actor->lastlook = look;
     return false;
 }
 
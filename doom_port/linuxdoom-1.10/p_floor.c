@@ -56,6 +56,8 @@ T_MovePlane
 {
     boolean	flag;
     fixed_t	lastpos;
+
+    sector->planesmoved = true;
 	
     switch(floorOrCeiling)
     {
@@ -783,6 +783,9 @@ P_DamageMobj
     player_t*	player;
     fixed_t	thrust;
     int		temp;
+
+    // A_VileAttack throws the target even if it's dead.
+    P_WakeMobj (target);
 	
     if ( !(target->flags & MF_SHOOTABLE) )
 	return;	// shouldn't happen...
@@ -41,6 +41,13 @@
 #define MAPBMASK		(MAPBLOCKSIZE-1)
 #define MAPBTOFRAC		(MAPBLOCKSHIFT-FRACBITS)
 
+// The things of a mapblock are also kept by cell,
+//  4 by 4 cells of 32 units, and one more list
+//  for those wider than MAXRADIUS.
+#define CELLSHIFT		(MAPBLOCKSHIFT-2)
+#define BLOCKCELLS		17
+#define BIGCELL			16
+
 
 // player radius for movement checking
 #define PLAYERRADIUS	16*FRACUNIT
@@ -70,10 +77,21 @@
 extern	thinker_t	thinkercap;	
 
 
+// Set by -globalthinkers, every tic runs the thinkers
+//  in the order they were added, as demos and netgames do.
+// Otherwise they run a class at a time.
+extern	boolean		globalthinkers;
+
 void P_InitThinkers (void);
 void P_AddThinker (thinker_t* thinker);
 void P_RemoveThinker (thinker_t* thinker);
 
+// A mobj that can't change until something else acts on it
+//  stops thinking until damaged, moved by a sector,
+//  set to a new state or removed.
+void P_SleepMobj (mobj_t* mobj);
+void P_WakeMobj (mobj_t* mobj);
+
 
 //
 // P_PSPR
@@ -175,6 +193,15 @@ void 	P_LineOpening (line_t* linedef);
 boolean P_BlockLinesIterator (int x, int y, boolean(*func)(line_t*) );
 boolean P_BlockThingsIterator (int x, int y, boolean(*func)(mobj_t*) );
 
+// Only the things that could reach into box,
+//  in the same order as P_BlockThingsIterator.
+boolean
+P_BlockThingsBoxIterator
+( int		x,
+  int		y,
+  fixed_t*	box,
+  boolean(*func)(mobj_t*) );
+
 #define PT_ADDLINES		1
 #define PT_ADDTHINGS	2
 #define PT_EARLYOUT		4
@@ -212,6 +239,19 @@ boolean P_TryMove (mobj_t* thing, fixed_t x, fixed_t y);
 boolean P_TeleportMove (mobj_t* thing, fixed_t x, fixed_t y);
 void	P_SlideMove (mobj_t* mo);
 boolean P_CheckSight (mobj_t* t1, mobj_t* t2);
+
+// P_CheckSight for t1[i] to t2[i], all in one walk of the BSP.
+void
+P_CheckSights
+( mobj_t**	t1,
+  mobj_t**	t2,
+  int		count,
+  boolean*	seen );
+
+// Forgets the sight lines checked so far,
+//  called each tic and whenever a sector moves.
+void P_ClearSightCache (void);
+
 void 	P_UseLines (player_t* player);
 
 boolean P_ChangeSector (sector_t* sector, boolean crunch);
@@ -244,6 +284,7 @@ P_RadiusAttack
 // P_SETUP
 //
 extern byte*		rejectmatrix;	// for fast sight rejection
+extern boolean		rejectbuilt;	// from the PVS, the map's was empty
 extern short*		blockmaplump;	// offsets in blockmap are from here
 extern short*		blockmap;
 extern int		bmapwidth;
@@ -252,6 +293,10 @@ extern fixed_t		bmaporgx;
 extern fixed_t		bmaporgy;	// origin of block map
 extern mobj_t**		blocklinks;	// for thing chains
 
+// BLOCKCELLS thing chains per block, NULL with -nothinggrid.
+extern mobj_t**		celllinks;
+extern boolean		thinggrid;
+
 
 
 //
@@ -383,6 +383,7 @@ P_CheckPosition
     int			yh;
     int			bx;
     int			by;
+    fixed_t		thingbox[4];
     subsector_t*	newsubsec;
 
     tmthing = thing;
@@ -422,9 +423,17 @@ P_CheckPosition
     yl = (tmbbox[BOXBOTTOM] - bmaporgy - MAXRADIUS)>>MAPBLOCKSHIFT;
     yh = (tmbbox[BOXTOP] - bmaporgy + MAXRADIUS)>>MAPBLOCKSHIFT;
 
+    // PIT_CheckThing passes over anything with its origin
+    //  further out than both radii, so only those cells
+    //  of the blocks need walking.
+    thingbox[BOXTOP] = tmbbox[BOXTOP] + MAXRADIUS;
+    thingbox[BOXBOTTOM] = tmbbox[BOXBOTTOM] - MAXRADIUS;
+    thingbox[BOXRIGHT] = tmbbox[BOXRIGHT] + MAXRADIUS;
+    thingbox[BOXLEFT] = tmbbox[BOXLEFT] - MAXRADIUS;
+
     for (bx=xl ; bx<=xh ; bx++)
 	for (by=yl ; by<=yh ; by++)
-	    if (!P_BlockThingsIterator(bx,by,PIT_CheckThing))
+	    if (!P_BlockThingsBoxIterator(bx,by,thingbox,PIT_CheckThing))
 		return false;
     
     // check lines
@@ -1257,6 +1266,8 @@ boolean		nofit;
 boolean PIT_ChangeSector (mobj_t*	thing)
 {
     mobj_t*	mo;
+
+    P_WakeMobj (thing);
 	
     if (P_ThingHeightClip (thing))
     {
@@ -1327,6 +1338,9 @@ P_ChangeSector
 	
     nofit = false;
     crushchange = crunch;
+
+    // the sector may open or close sight lines
+    P_ClearSightCache ();
 	
     // re-check heights for all things near the moving sector
     for (x=sector->blockbox[BOXLEFT] ; x<= sector->blockbox[BOXRIGHT] ; x++)
@@ -344,6 +344,42 @@ void P_LineOpening (line_t* linedef)
 // lookups maintaining lists ot things inside
 // these structures need to be updated.
 //
+// counts links into the blockmap, newer is bigger
+static unsigned long long	blockseq;
+
+
+//
+// P_LinkCell
+//
+static void
+P_LinkCell
+( mobj_t*	thing,
+  int		block )
+{
+    mobj_t**	link;
+    int		cell;
+
+    if (thing->radius > MAXRADIUS)
+	cell = BIGCELL;
+    else
+	cell = (((thing->y - bmaporgy)>>CELLSHIFT)&3)*4
+	    + (((thing->x - bmaporgx)>>CELLSHIFT)&3);
+
+    thing->cell = block*BLOCKCELLS + cell;
+    thing->blockseq = ++blockseq;
+
+    link = &celllinks[thing->cell];
+    thing->cprev = NULL;
+    thing->cnext = *link;
+    if (*link)
+	(*link)->cprev = thing;
+    *link = thing;
+}
+
+
+//
+// P_UnsetThingPosition
+//
 void P_UnsetThingPosition (mobj_t* thing)
 {
     int		blockx;
@@ -382,6 +418,17 @@ void P_UnsetThingPosition (mobj_t* thing)
 		blocklinks[blocky*bmapwidth+blockx] = thing->bnext;
 	    }
 	}
+
+	if (celllinks && thing->cell >= 0)
+	{
+	    if (thing->cnext)
+		thing->cnext->cprev = thing->cprev;
+
+	    if (thing->cprev)
+		thing->cprev->cnext = thing->cnext;
+	    else
+		celllinks[thing->cell] = thing->cnext;
+	}
     }
 }
 
@@ -440,11 +487,15 @@ P_SetThingPosition (mobj_t* thing)
 		(*link)->bprev = thing;
 
 	    *link = thing;
+
+	    if (celllinks)
+		P_LinkCell (thing, blocky*bmapwidth+blockx);
 	}
 	else
 	{
 	    // thing is off the map
 	    thing->bnext = thing->bprev = NULL;
+	    thing->cell = -1;
 	}
     }
 }
@@ -537,6 +588,86 @@ P_BlockThingsIterator
 }
 
 
+//
+// P_BlockThingsBoxIterator
+// The cells box touches, and the wide things,
+//  merged back into the order of the block.
+//
+boolean
+P_BlockThingsBoxIterator
+( int			x,
+  int			y,
+  fixed_t*		box,
+  boolean(*func)(mobj_t*) )
+{
+    mobj_t*		lists[BLOCKCELLS];
+    mobj_t**		cells;
+    mobj_t*		mobj;
+    int			count;
+    int			cx1;
+    int			cx2;
+    int			cy1;
+    int			cy2;
+    int			cx;
+    int			cy;
+    int			best;
+    int			i;
+
+    if (!celllinks)
+	return P_BlockThingsIterator (x, y, func);
+
+    if ( x<0
+	 || y<0
+	 || x>=bmapwidth
+	 || y>=bmapheight)
+    {
+	return true;
+    }
+
+    cx1 = ((box[BOXLEFT] - bmaporgx)>>CELLSHIFT) - (x<<2);
+    cx2 = ((box[BOXRIGHT] - bmaporgx)>>CELLSHIFT) - (x<<2);
+    cy1 = ((box[BOXBOTTOM] - bmaporgy)>>CELLSHIFT) - (y<<2);
+    cy2 = ((box[BOXTOP] - bmaporgy)>>CELLSHIFT) - (y<<2);
+    if (cx1 < 0)
+	cx1 = 0;
+    if (cx2 > 3)
+	cx2 = 3;
+    if (cy1 < 0)
+	cy1 = 0;
+    if (cy2 > 3)
+	cy2 = 3;
+
+    cells = &celllinks[(y*bmapwidth+x)*BLOCKCELLS];
+    count = 0;
+    for (cy=cy1 ; cy<=cy2 ; cy++)
+	for (cx=cx1 ; cx<=cx2 ; cx++)
+	    if (cells[cy*4+cx])
+		lists[count++] = cells[cy*4+cx];
+    if (cells[BIGCELL])
+	lists[count++] = cells[BIGCELL];
+
+    // newest first, as they are in the block
+    while (count)
+    {
+	best = 0;
+	for (i=1 ; i<count ; i++)
+	    if (lists[i]->blockseq > lists[best]->blockseq)
+		best = i;
+
+	mobj = lists[best];
+	if (!func (mobj))
+	    return false;
+
+	// read after, as P_BlockThingsIterator does
+	if (mobj->cnext)
+	    lists[best] = mobj->cnext;
+	else
+	    lists[best] = lists[--count];
+    }
+    return true;
+}
+
+
 
 //
 // INTERCEPT ROUTINES
@@ -57,6 +57,8 @@ P_SetMobjState
 {
     state_t*	st;
 
+    P_WakeMobj (mobj);
+
     do
     {
 	if (state == S_NULL)
@@ -398,6 +400,7 @@ P_NightmareRespawn (mobj_t* mobj)
     mo = P_SpawnMobj (x,y,z, mobj->type);
     mo->spawnpoint = mobj->spawnpoint;	
     mo->angle = ANG45 * (mthing->angle/45);
+    mo->oldangle = mo->angle;
 
     if (mthing->options & MTF_AMBUSH)
 	mo->flags |= MF_AMBUSH;
@@ -449,6 +452,19 @@ void P_MobjThinker (mobj_t* mobj)
     }
     else
     {
+	// Nothing here does anything from now on.
+	// Players are left out, P_PlayerThink moves them.
+	if (!mobj->momx
+	    && !mobj->momy
+	    && !mobj->momz
+	    && mobj->z == mobj->floorz
+	    && !(mobj->flags & MF_SKULLFLY)
+	    && !((mobj->flags & MF_COUNTKILL) && respawnmonsters)
+	    && !mobj->player)
+	{
+	    P_SleepMobj (mobj);
+	}
+
 	// check for nightmare respawn
 	if (! (mobj->flags & MF_COUNTKILL) )
 	    return;
@@ -526,6 +542,12 @@ P_SpawnMobj
     else 
 	mobj->z = z;
 
+    // nothing to interpolate from yet
+    mobj->oldx = mobj->x;
+    mobj->oldy = mobj->y;
+    mobj->oldz = mobj->z;
+    mobj->oldangle = mobj->angle;
+
     mobj->thinker.function.acp1 = (actionf_p1)P_MobjThinker;
 	
     P_AddThinker (&mobj->thinker);
@@ -545,6 +567,9 @@ int		iquetail;
 
 void P_RemoveMobj (mobj_t* mobj)
 {
+    // back with the thinkers that get freed
+    P_WakeMobj (mobj);
+
     if ((mobj->flags & MF_SPECIAL)
 	&& !(mobj->flags & MF_DROPPED)
 	&& (mobj->type != MT_INV)
@@ -625,6 +650,7 @@ void P_RespawnSpecials (void)
     mo = P_SpawnMobj (x,y,z, i);
     mo->spawnpoint = *mthing;	
     mo->angle = ANG45 * (mthing->angle/45);
+    mo->oldangle = mo->angle;
 
     // pull it from the que
     iquetail = (iquetail+1)&(ITEMQUESIZE-1);
@@ -669,6 +695,8 @@ void P_SpawnPlayer (mapthing_t* mthing)
 	mobj->flags |= (mthing->type-1)<<MF_TRANSSHIFT;
 		
     mobj->angle	= ANG45 * (mthing->angle/45);
+		
+    mobj->oldangle = mobj->angle;
     mobj->player = p;
     mobj->health = p->health;
 
@@ -681,6 +709,8 @@ void P_SpawnPlayer (mapthing_t* mthing)
     p->extralight = 0;
     p->fixedcolormap = 0;
     p->viewheight = VIEWHEIGHT;
+    p->viewz = mobj->z + VIEWHEIGHT;
+    p->oldviewz = p->viewz;
 
     // setup gun psprite
     P_SetupPsprites (p);
@@ -792,6 +822,8 @@ void P_SpawnMapThing (mapthing_t* mthing)
 	totalitems++;
 		
     mobj->angle = ANG45 * (mthing->angle/45);
+		
+    mobj->oldangle = mobj->angle;
     if (mthing->options & MTF_AMBUSH)
 	mobj->flags |= MF_AMBUSH;
 }
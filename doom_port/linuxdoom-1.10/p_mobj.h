@@ -227,6 +227,13 @@ typedef struct mobj_s
     // Links in blocks (if needed).
     struct mobj_s*	bnext;
     struct mobj_s*	bprev;
+
+    // Links in the cell of the block, newest first
+    //  like the block, blockseq says how new.
+    struct mobj_s*	cnext;
+    struct mobj_s*	cprev;
+    int			cell;
+    unsigned long long	blockseq;
     
     struct subsector_s*	subsector;
 
@@ -282,6 +289,17 @@ typedef struct mobj_s
 
     // Thing being chased/attacked for tracers.
     struct mobj_s*	tracer;	
+
+    // Position and angle at the start of the current tic,
+    //  only used by the refresh to interpolate between tics.
+    fixed_t		oldx;
+    fixed_t		oldy;
+    fixed_t		oldz;
+    angle_t		oldangle;
+
+    // Nothing to do until something else touches it,
+    //  see P_SleepMobj.
+    boolean		dormant;
     
 } mobj_t;
 
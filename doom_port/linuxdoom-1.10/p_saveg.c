@@ -31,6 +31,7 @@ rcsid[] = "$Id: p_tick.c,v 1.4 1997/02/03 16:47:55 b1 Exp $";
 // State.
 #include "doomstat.h"
 #include "r_state.h"
+#include "am_map.h"
 
 byte*		save_p;
 
@@ -93,6 +94,7 @@ void P_UnArchivePlayers (void)
 	
 	// will be set when unarc thinker
 	players[i].mo = NULL;	
+	players[i].oldviewz = players[i].viewz;
 	players[i].message = NULL;
 	players[i].attacker = NULL;
 
@@ -208,6 +210,9 @@ void P_UnArchiveWorld (void)
 	}
     }
     save_p = (byte *)get;	
+
+    // heights and ML_MAPPED have changed under the automap
+    AM_InitLines ();
 }
 
 
@@ -306,10 +311,19 @@ void P_UnArchiveThinkers (void)
 		mobj->player = &players[(int)mobj->player-1];
 		mobj->player->mo = mobj;
 	    }
+	    // the cell links are pointers into the old game
+	    mobj->cnext = mobj->cprev = NULL;
+	    mobj->cell = -1;
+	    mobj->blockseq = 0;
 	    P_SetThingPosition (mobj);
 	    mobj->info = &mobjinfo[mobj->type];
 	    mobj->floorz = mobj->subsector->sector->floorheight;
 	    mobj->ceilingz = mobj->subsector->sector->ceilingheight;
+	    mobj->oldx = mobj->x;
+	    mobj->oldy = mobj->y;
+	    mobj->oldz = mobj->z;
+	    mobj->oldangle = mobj->angle;
+	    mobj->dormant = false;
 	    mobj->thinker.function.acp1 = (actionf_p1)P_MobjThinker;
 	    P_AddThinker (&mobj->thinker);
 	    break;
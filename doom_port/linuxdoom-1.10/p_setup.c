@@ -26,6 +26,8 @@ static const char
 rcsid[] = "$Id: p_setup.c,v 1.5 1997/02/03 22:45:12 b1 Exp $";
 
 
+#include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 #include "z_zone.h"
@@ -36,15 +38,21 @@ rcsid[] = "$Id: p_setup.c,v 1.5 1997/02/03 22:45:12 b1 Exp $";
 #include "g_game.h"
 
 #include "i_system.h"
+#include "m_argv.h"
 #include "w_wad.h"
 
 #include "doomdef.h"
 #include "p_local.h"
+#include "p_setup.h"
 
 #include "s_sound.h"
 
 #include "doomstat.h"
 
+#include "r_pvs.h"
+#include "r_mip.h"
+#include "am_map.h"
+
 
 void	P_SpawnMapThing (mapthing_t*	mthing);
 
@@ -93,6 +101,8 @@ fixed_t		bmaporgx;
 fixed_t		bmaporgy;
 // for thing chains
 mobj_t**	blocklinks;		
+mobj_t**	celllinks;
+boolean		thinggrid;
 
 
 // REJECT
@@ -103,6 +113,7 @@ mobj_t**	blocklinks;
 //  used as a PVS lookup as well.
 //
 byte*		rejectmatrix;
+boolean		rejectbuilt;
 
 
 // Maintain single and multi player starting spots.
@@ -165,6 +176,9 @@ void P_LoadSegs (int lump)
     line_t*		ldef;
     int			linedef;
     int			side;
+    double		dx;
+    double		dy;
+    double		length;
 	
     numsegs = W_LumpLength (lump) / sizeof(mapseg_t);
     segs = Z_Malloc (numsegs*sizeof(seg_t),PU_LEVEL,0);	
@@ -190,6 +204,15 @@ void P_LoadSegs (int lump)
 	    li->backsector = sides[ldef->sidenum[side^1]].sector;
 	else
 	    li->backsector = 0;
+
+	dx = (double)li->v2->x - li->v1->x;
+	dy = (double)li->v2->y - li->v1->y;
+	length = sqrt (dx*dx + dy*dy);
+	if (length > 0)
+	{
+	    li->dirx = dx * FRACUNIT / length;
+	    li->diry = dy * FRACUNIT / length;
+	}
     }
 	
     Z_Free (data);
@@ -295,6 +318,132 @@ void P_LoadNodes (int lump)
 }
 
 
+//
+// P_OrderBSP
+// A tree written bottom up, children before their parent,
+//  already keeps each subtree together. Others don't, and
+//  the walks in the renderer and P_CheckSight jump all
+//  over nodes[]. Either way the result is the same:
+// Lay the nodes out depth first, each child next to its parent,
+//  the subsectors in the order the walk reaches them,
+//  and their segs behind each other in the same order.
+// The root stays the last node.
+//
+void P_OrderBSP (void)
+{
+    int			stack[MAXBSPDEPTH+1];
+    int			depth[MAXBSPDEPTH+1];
+    int			sp;
+    int			bspnum;
+    int			d;
+    int			n;
+    int			numss;
+    int			i;
+    int			j;
+    int*		nodemap;
+    int*		ssmap;
+    node_t*		no;
+    node_t*		newnodes;
+    subsector_t*	ss;
+    subsector_t*	newsubsectors;
+    seg_t*		newsegs;
+
+    if (!numnodes)
+	return;
+
+    nodemap = Z_Malloc (numnodes*sizeof(int), PU_STATIC, 0);
+    ssmap = Z_Malloc (numsubsectors*sizeof(int), PU_STATIC, 0);
+    memset (nodemap, -1, numnodes*sizeof(int));
+    memset (ssmap, -1, numsubsectors*sizeof(int));
+
+    n = 0;
+    numss = 0;
+    sp = 0;
+    stack[sp] = numnodes-1;
+    depth[sp++] = 1;
+    while (sp)
+    {
+	sp--;
+	bspnum = stack[sp];
+	d = depth[sp];
+
+	if (bspnum & NF_SUBSECTOR)
+	{
+	    bspnum &= ~NF_SUBSECTOR;
+	    if (bspnum >= numsubsectors || ssmap[bspnum] != -1)
+		break;
+	    ssmap[bspnum] = numss++;
+	    continue;
+	}
+
+	if (bspnum >= numnodes || nodemap[bspnum] != -1)
+	    break;
+	if (d > MAXBSPDEPTH)
+	    I_Error ("P_OrderBSP: BSP deeper than %i nodes", MAXBSPDEPTH);
+
+	nodemap[bspnum] = numnodes-1 - n++;
+	no = &nodes[bspnum];
+	stack[sp] = no->children[1];
+	depth[sp++] = d+1;
+	stack[sp] = no->children[0];
+	depth[sp++] = d+1;
+    }
+
+    // Not a proper tree, leave it the way it came.
+    if (sp || n != numnodes || numss != numsubsectors)
+    {
+	Z_Free (ssmap);
+	Z_Free (nodemap);
+	return;
+    }
+
+    newnodes = Z_Malloc (numnodes*sizeof(node_t), PU_LEVEL, 0);
+    for (i=0 ; i<numnodes ; i++)
+    {
+	no = &newnodes[nodemap[i]];
+	*no = nodes[i];
+	for (j=0 ; j<2 ; j++)
+	{
+	    if (no->children[j] & NF_SUBSECTOR)
+		no->children[j] = NF_SUBSECTOR
+		    | ssmap[no->children[j] & ~NF_SUBSECTOR];
+	    else
+		no->children[j] = nodemap[no->children[j]];
+	}
+    }
+    Z_Free (nodes);
+    nodes = newnodes;
+
+    newsubsectors = Z_Malloc (numsubsectors*sizeof(subsector_t), PU_LEVEL, 0);
+    for (i=0 ; i<numsubsectors ; i++)
+	newsubsectors[ssmap[i]] = subsectors[i];
+    Z_Free (subsectors);
+    subsectors = newsubsectors;
+
+    n = 0;
+    for (i=0 ; i<numsubsectors ; i++)
+	n += subsectors[i].numlines;
+
+    if (n == numsegs)
+    {
+	newsegs = Z_Malloc (numsegs*sizeof(seg_t), PU_LEVEL, 0);
+	n = 0;
+	for (i=0, ss=subsectors ; i<numsubsectors ; i++, ss++)
+	{
+	    memcpy (&newsegs[n], &segs[ss->firstline],
+		    ss->numlines*sizeof(seg_t));
+	    ss->firstline = n;
+	    n += ss->numlines;
+	}
+	Z_Free (segs);
+	segs = newsegs;
+    }
+
+    Z_Free (ssmap);
+    Z_Free (nodemap);
+}
+
+
 //
 // P_LoadThings
 //
@@ -487,6 +636,22 @@ void P_LoadBlockMap (int lump)
     count = sizeof(*blocklinks)* bmapwidth*bmapheight;
     blocklinks = Z_Malloc (count,PU_LEVEL, 0);
     memset (blocklinks, 0, count);
+
+    // Only worth a quarter of what the zone has left,
+    //  the level still has to load after it.
+    celllinks = NULL;
+    if (thinggrid)
+    {
+	count *= BLOCKCELLS;
+	if (count > Z_FreeMemory ()/4)
+	{
+	    printf ("P_LoadBlockMap: %i blocks, no room for the thing "
+		    "cells\n", bmapwidth*bmapheight);
+	    return;
+	}
+	celllinks = Z_Malloc (count, PU_LEVEL, 0);
+	memset (celllinks, 0, count);
+    }
 }
 
 
@@ -577,6 +742,115 @@ void P_GroupLines (void)
 }
 
 
+//
+// P_SetupReject
+// Lots of PWADs have a REJECT of all zeroes, which rejects
+//  nothing. The PVS has every sector pair that can't see
+//  each other with every door open, which is what REJECT
+//  holds, so an empty one is built from it.
+// Not for demos and netgames, the sight checks there
+//  have to come out as they did with the map's.
+// A sight line that just grazes a corner may not be
+//  in the PVS, so a pair is only rejected if neither
+//  sector nor any neighbour of it sees the other.
+// A row the PVS builder flood filled rejects nothing,
+//  and with both ends needed, neither does its column.
+//
+void P_SetupReject (int lump)
+{
+    int		size;
+    int		length;
+    int		total;
+    int		rowbytes;
+    int		pnum;
+    int		qnum;
+    int		i;
+    int		j;
+    byte*	row;
+    byte*	other;
+    sector_t*	sec;
+    sector_t*	next;
+
+    rejectbuilt = false;
+    rejectmatrix = W_CacheLumpNum (lump, PU_LEVEL);
+
+    if (!pvsmatrix
+	|| demoplayback
+	|| demoloading
+	|| demorecording
+	|| netgame)
+	return;
+
+    size = (numsectors*numsectors+7)>>3;
+    length = W_LumpLength (lump);
+    if (length > size)
+	length = size;
+    for (i=0 ; i<length ; i++)
+	if (rejectmatrix[i])
+	    return;
+
+    rejectmatrix = Z_Malloc (size, PU_LEVEL, 0);
+    memset (rejectmatrix, 0, size);
+
+    rowbytes = PVS_ROWBYTES(numsectors);
+    row = Z_Malloc (rowbytes, PU_STATIC, 0);
+
+    for (i=0, sec=sectors ; i<numsectors ; i++, sec++)
+    {
+	if (pvsflooded[i])
+	    continue;
+
+	// what this sector or its neighbours see
+	memcpy (row, pvsmatrix+i*rowbytes, rowbytes);
+	for (j=0 ; j<sec->linecount ; j++)
+	{
+	    next = sec->lines[j]->frontsector;
+	    if (next == sec)
+		next = sec->lines[j]->backsector;
+	    if (!next || next == sec)
+		continue;
+	    other = pvsmatrix + (next-sectors)*rowbytes;
+	    for (pnum=0 ; pnum<rowbytes ; pnum++)
+		row[pnum] |= other[pnum];
+	}
+
+	for (j=0 ; j<numsectors ; j++)
+	{
+	    if (row[j>>3] & (1<<(j&7)))
+		continue;
+	    pnum = i*numsectors + j;
+	    rejectmatrix[pnum>>3] |= 1<<(pnum&7);
+	}
+    }
+    Z_Free (row);
+
+    // and the same from the other end
+    total = 0;
+    for (i=0 ; i<numsectors ; i++)
+    {
+	for (j=0 ; j<i ; j++)
+	{
+	    pnum = i*numsectors + j;
+	    qnum = j*numsectors + i;
+	    if (!(rejectmatrix[pnum>>3] & (1<<(pnum&7)))
+		|| !(rejectmatrix[qnum>>3] & (1<<(qnum&7))))
+	    {
+		rejectmatrix[pnum>>3] &= ~(1<<(pnum&7));
+		rejectmatrix[qnum>>3] &= ~(1<<(qnum&7));
+		continue;
+	    }
+	    total += 2;
+	}
+    }
+    rejectbuilt = true;
+
+    printf ("P_SetupReject: empty REJECT, %i%% of sector pairs "
+	    "rejected by the PVS\n",
+	    (int)((double)total*100/((double)numsectors*numsectors)));
+}
+
+
+
 //
 // P_SetupLevel
 //
@@ -603,6 +877,9 @@ P_SetupLevel
     // will be set by player think.
     players[consoleplayer].viewz = 1; 
 
+    // for the level just left
+    P_ReportSight ();
+
     // Make sure all sounds are stopped before Z_FreeTags.
     S_Start ();			
 
@@ -655,9 +932,12 @@ P_SetupLevel
     P_LoadSubsectors (lumpnum+ML_SSECTORS);
     P_LoadNodes (lumpnum+ML_NODES);
     P_LoadSegs (lumpnum+ML_SEGS);
+    P_OrderBSP ();
 	
-    rejectmatrix = W_CacheLumpNum (lumpnum+ML_REJECT,PU_LEVEL);
     P_GroupLines ();
+    AM_InitLines ();
+    R_SetupPVS ();
+    P_SetupReject (lumpnum+ML_REJECT);
 
     bodyqueslot = 0;
     deathmatch_p = deathmatchstarts;
@@ -680,6 +960,8 @@ P_SetupLevel
 	
     // set up world state
     P_SpawnSpecials ();
+
+    R_InitLevelMips ();
 	
     // build subsector connect matrix
     //	UNUSED P_ConnectSubsectors ();
@@ -702,6 +984,8 @@ void P_Init (void)
     P_InitSwitchList ();
     P_InitPicAnims ();
     R_InitSprites (sprnames);
+    globalthinkers = M_CheckParm ("-globalthinkers");
+    thinggrid = !M_CheckParm ("-nothinggrid");
 }
 
 
@@ -40,6 +40,12 @@ P_SetupLevel
 // Called by startup code.
 void P_Init (void);
 
+// Prints how many sight checks REJECT turned down
+//  since the last call. Called when a level is left:
+//  at intermission, on a new level, when a demo ends
+//  and on quitting.
+void P_ReportSight (void);
+
 #endif
 //-----------------------------------------------------------------------------
 //
@@ -25,13 +25,17 @@ static const char
 rcsid[] = "$Id: p_sight.c,v 1.3 1997/01/28 22:08:28 b1 Exp $";
 
 
+#include <stdio.h>
+
 #include "doomdef.h"
 
 #include "i_system.h"
 #include "p_local.h"
+#include "p_setup.h"
 
 // State.
 #include "r_state.h"
+#include "m_prof.h"
 
 //
 // P_CheckSight
@@ -47,6 +51,133 @@ fixed_t		t2y;
 int		sightcounts[2];
 
 
+//
+// Sight cache.
+// Monsters check the same line several times a tic,
+//  A_Chase, the attack checks and the refires.
+// The result only depends on the ends and the sector
+//  heights, so the ends are the key, and anything
+//  cached goes when a sector moves or the tic ends.
+//
+#define SIGHTCACHE	1024
+
+typedef struct
+{
+    mobj_t*	t1;
+    mobj_t*	t2;
+    fixed_t	x1;
+    fixed_t	y1;
+    fixed_t	z1;		// eye
+    fixed_t	x2;
+    fixed_t	y2;
+    fixed_t	z2;
+    fixed_t	height2;
+    int		stamp;
+    boolean	seen;
+
+} sightentry_t;
+
+static sightentry_t	sightcache[SIGHTCACHE];
+static int		sightstamp = 1;
+
+
+
+//
+// P_ReportSight
+//
+void P_ReportSight (void)
+{
+    int		total;
+
+    total = sightcounts[0] + sightcounts[1];
+    if (total)
+    {
+	printf ("P_CheckSight: %i checks, %i%% rejected by the %s REJECT\n",
+		total, (int)((double)sightcounts[0]*100/total),
+		rejectbuilt ? "built" : "map's");
+    }
+    sightcounts[0] = sightcounts[1] = 0;
+}
+
+
+//
+// P_ClearSightCache
+//
+void P_ClearSightCache (void)
+{
+    sightstamp++;
+}
+
+
+//
+// P_SightEntry
+//
+static sightentry_t*
+P_SightEntry
+( mobj_t*	t1,
+  mobj_t*	t2 )
+{
+    unsigned long	h;
+
+    h = ((unsigned long)t1>>4) * 31 + ((unsigned long)t2>>4);
+    return &sightcache[(h ^ (h>>10)) & (SIGHTCACHE-1)];
+}
+
+
+//
+// P_SightCached
+// Returns true and sets seen if the line is in the cache.
+//
+static boolean
+P_SightCached
+( sightentry_t*	entry,
+  mobj_t*	t1,
+  mobj_t*	t2,
+  boolean*	seen )
+{
+    if (entry->stamp != sightstamp
+	|| entry->t1 != t1
+	|| entry->t2 != t2
+	|| entry->x1 != t1->x
+	|| entry->y1 != t1->y
+	|| entry->z1 != t1->z + t1->height - (t1->height>>2)
+	|| entry->x2 != t2->x
+	|| entry->y2 != t2->y
+	|| entry->z2 != t2->z
+	|| entry->height2 != t2->height)
+	return false;
+
+    *seen = entry->seen;
+    if (profiling)
+	M_ProfCount (pc_sighthits, 1);
+    return true;
+}
+
+
+//
+// P_CacheSight
+//
+static void
+P_CacheSight
+( sightentry_t*	entry,
+  mobj_t*	t1,
+  mobj_t*	t2,
+  boolean	seen )
+{
+    entry->t1 = t1;
+    entry->t2 = t2;
+    entry->x1 = t1->x;
+    entry->y1 = t1->y;
+    entry->z1 = t1->z + t1->height - (t1->height>>2);
+    entry->x2 = t2->x;
+    entry->y2 = t2->y;
+    entry->z2 = t2->z;
+    entry->height2 = t2->height;
+    entry->stamp = sightstamp;
+    entry->seen = seen;
+}
+
+
 //
 // P_DivlineSide
 // Returns side 0 (front), 1 (back), or 2 (on).
@@ -253,51 +384,63 @@ boolean P_CrossSubsector (int num)
 // P_CrossBSPNode
 // Returns true
 //  if strace crosses the given node successfully.
+// Walks the tree with an explicit stack,
+//  in the same order as the renderer.
 //
 boolean P_CrossBSPNode (int bspnum)
 {
+    int		stack[MAXBSPDEPTH];
+    int		sp;
     node_t*	bsp;
     int		side;
 
-    if (bspnum & NF_SUBSECTOR)
+    sp = 0;
+    while (1)
     {
+	while ( !(bspnum & NF_SUBSECTOR) )
+	{
+	    bsp = &nodes[bspnum];
+    
+	    // decide which side the start point is on
+	    side = P_DivlineSide (strace.x, strace.y, (divline_t *)bsp);
+	    if (side == 2)
+		side = 0;	// an "on" should cross both sides
+
+	    // cross the starting side first
+	    stack[sp++] = (bspnum<<1) | side;
+	    bspnum = bsp->children[side];
+	}
+
 	if (bspnum == -1)
-	    return P_CrossSubsector (0);
+	    bspnum = 0;
 	else
-	    return P_CrossSubsector (bspnum&(~NF_SUBSECTOR));
-    }
-		
-    bsp = &nodes[bspnum];
-    
-    // decide which side the start point is on
-    side = P_DivlineSide (strace.x, strace.y, (divline_t *)bsp);
-    if (side == 2)
-	side = 0;	// an "on" should cross both sides
+	    bspnum &= ~NF_SUBSECTOR;
+	if (!P_CrossSubsector (bspnum))
+	    return false;
 
-    // cross the starting side
-    if (!P_CrossBSPNode (bsp->children[side]) )
-	return false;
-	
-    // the partition plane is crossed here
-    if (side == P_DivlineSide (t2x, t2y,(divline_t *)bsp))
-    {
-	// the line doesn't touch the other side
-	return true;
+	// Back up to the first partition plane crossed,
+	//  the others the line doesn't touch the other side of.
+	do
+	{
+	    if (!sp)
+		return true;
+	    sp--;
+	    bsp = &nodes[stack[sp]>>1];
+	    side = stack[sp]&1;
+	} while (side == P_DivlineSide (t2x, t2y,(divline_t *)bsp));
+
+	// cross the ending side
+	bspnum = bsp->children[side^1];
     }
-    
-    // cross the ending side		
-    return P_CrossBSPNode (bsp->children[side^1]);
 }
 
 
 //
-// P_CheckSight
-// Returns true
-//  if a straight line between t1 and t2 is unobstructed.
-// Uses REJECT.
+// P_SightRejected
+// True if REJECT says t1 can't possibly see t2.
 //
-boolean
-P_CheckSight
+static boolean
+P_SightRejected
 ( mobj_t*	t1,
   mobj_t*	t2 )
 {
@@ -306,8 +449,6 @@ P_CheckSight
     int		pnum;
     int		bytenum;
     int		bitnum;
-    
-    // First check for trivial rejection.
 
     // Determine subsector entries in REJECT table.
     s1 = (t1->subsector->sector - sectors);
@@ -322,15 +463,24 @@ P_CheckSight
 	sightcounts[0]++;
 
 	// can't possibly be connected
-	return false;	
+	return true;
     }
 
     // An unobstructed LOS is possible.
-    // Now look from eyes of t1 to any part of t2.
     sightcounts[1]++;
+    return false;
+}
 
-    validcount++;
-	
+
+//
+// P_StartSight
+// Sets up the trace from the eyes of t1 to any part of t2.
+//
+static void
+P_StartSight
+( mobj_t*	t1,
+  mobj_t*	t2 )
+{
     sightzstart = t1->z + t1->height - (t1->height>>2);
     topslope = (t2->z+t2->height) - sightzstart;
     bottomslope = (t2->z) - sightzstart;
@@ -341,9 +491,232 @@ P_CheckSight
     t2y = t2->y;
     strace.dx = t2->x - t1->x;
     strace.dy = t2->y - t1->y;
+}
+
+
+//
+// P_CheckSight
+// Returns true
+//  if a straight line between t1 and t2 is unobstructed.
+// Uses REJECT.
+//
+boolean
+P_CheckSight
+( mobj_t*	t1,
+  mobj_t*	t2 )
+{
+    sightentry_t*	entry;
+    unsigned		misses;
+    boolean		seen;
+    
+    // First check for trivial rejection.
+    if (P_SightRejected (t1, t2))
+	return false;
+
+    entry = P_SightEntry (t1, t2);
+    if (P_SightCached (entry, t1, t2, &seen))
+	return seen;
+
+    // Now look from eyes of t1 to any part of t2.
+    validcount++;
+    P_StartSight (t1, t2);
 
     // the head node is the last node output
-    return P_CrossBSPNode (numnodes-1);	
+    if (!profiling)
+	seen = P_CrossBSPNode (numnodes-1);
+    else
+    {
+	misses = M_ProfMisses ();
+	seen = P_CrossBSPNode (numnodes-1);
+	M_ProfCount (pc_sightmisses, M_ProfMisses () - misses);
+    }
+
+    P_CacheSight (entry, t1, t2, seen);
+    return seen;
+}
+
+
+
+//
+// Batched sight checks.
+// A line can take the subsectors along it in any order,
+//  the slopes only ever close in, so the lines of a batch
+//  walk the tree together, each node going to the lines
+//  that cross it, and come out as P_CheckSight would.
+//
+#define MAXSIGHTBATCH	32
+
+typedef struct
+{
+    divline_t	trace;
+    fixed_t	x2;
+    fixed_t	y2;
+    fixed_t	zstart;
+    fixed_t	top;
+    fixed_t	bottom;
+    int		valid;		// validcount of its own
+
+} sightline_t;
+
+
+//
+// P_CrossBSPNodes
+// Returns the lines in live that cross the tree.
+//
+static unsigned
+P_CrossBSPNodes
+( sightline_t*	lines,
+  unsigned	live )
+{
+    int		stack[MAXBSPDEPTH*2][2];
+    int		sp;
+    int		bspnum;
+    unsigned	mask;
+    unsigned	sides[2];
+    node_t*	bsp;
+    sightline_t* line;
+    int		side;
+    int		i;
+
+    sp = 0;
+    stack[sp][0] = numnodes-1;
+    stack[sp][1] = live;
+    sp++;
+
+    while (sp)
+    {
+	sp--;
+	bspnum = stack[sp][0];
+	mask = stack[sp][1] & live;
+	if (!mask)
+	    continue;
+
+	if (bspnum & NF_SUBSECTOR)
+	{
+	    if (bspnum == -1)
+		bspnum = 0;
+	    else
+		bspnum &= ~NF_SUBSECTOR;
+
+	    for (i=0 ; mask ; i++, mask >>= 1)
+	    {
+		if (!(mask & 1))
+		    continue;
+
+		line = &lines[i];
+		strace = line->trace;
+		t2x = line->x2;
+		t2y = line->y2;
+		sightzstart = line->zstart;
+		topslope = line->top;
+		bottomslope = line->bottom;
+		validcount = line->valid;
+
+		if (!P_CrossSubsector (bspnum))
+		    live &= ~(1u<<i);
+
+		line->top = topslope;
+		line->bottom = bottomslope;
+	    }
+	    continue;
+	}
+
+	// the starting side, and the ending one if it's different
+	bsp = &nodes[bspnum];
+	sides[0] = sides[1] = 0;
+	for (i=0 ; mask ; i++, mask >>= 1)
+	{
+	    if (!(mask & 1))
+		continue;
+
+	    line = &lines[i];
+	    side = P_DivlineSide (line->trace.x, line->trace.y,
+				  (divline_t *)bsp);
+	    if (side == 2)
+		side = 0;
+	    sides[side] |= 1u<<i;
+	    if (side != P_DivlineSide (line->x2, line->y2, (divline_t *)bsp))
+		sides[side^1] |= 1u<<i;
+	}
+
+	for (side=0 ; side<2 ; side++)
+	{
+	    if (!sides[side])
+		continue;
+	    stack[sp][0] = bsp->children[side];
+	    stack[sp][1] = sides[side];
+	    sp++;
+	}
+    }
+
+    return live;
+}
+
+
+//
+// P_CheckSights
+//
+void
+P_CheckSights
+( mobj_t**	t1,
+  mobj_t**	t2,
+  int		count,
+  boolean*	seen )
+{
+    sightline_t		lines[MAXSIGHTBATCH];
+    sightentry_t*	entries[MAXSIGHTBATCH];
+    unsigned		live;
+    unsigned		traced;
+    int			first;
+    int			n;
+    int			i;
+
+    for (first=0 ; first<count ; first+=MAXSIGHTBATCH)
+    {
+	n = count-first;
+	if (n > MAXSIGHTBATCH)
+	    n = MAXSIGHTBATCH;
+
+	live = 0;
+	for (i=0 ; i<n ; i++)
+	{
+	    seen[first+i] = false;
+	    if (P_SightRejected (t1[first+i], t2[first+i]))
+		continue;
+
+	    entries[i] = P_SightEntry (t1[first+i], t2[first+i]);
+	    if (P_SightCached (entries[i], t1[first+i], t2[first+i],
+			       &seen[first+i]))
+		continue;
+
+	    P_StartSight (t1[first+i], t2[first+i]);
+	    lines[i].trace = strace;
+	    lines[i].x2 = t2x;
+	    lines[i].y2 = t2y;
+	    lines[i].zstart = sightzstart;
+	    lines[i].top = topslope;
+	    lines[i].bottom = bottomslope;
+	    lines[i].valid = ++validcount;
+	    live |= 1u<<i;
+	}
+
+	if (!live)
+	    continue;
+
+	traced = live;
+	i = validcount;
+	live = P_CrossBSPNodes (lines, live);
+	validcount = i;
+
+	for (i=0 ; i<n ; i++)
+	{
+	    if (!(traced & (1u<<i)))
+		continue;
+	    seen[first+i] = (live>>i) & 1;
+	    P_CacheSight (entries[i], t1[first+i], t2[first+i],
+			  seen[first+i]);
+	}
+    }
 }
 
 
@@ -187,6 +187,34 @@ void P_InitPicAnims (void)
 }
 
 
+//
+// P_AnimTextureRange
+// The wall textures texture cycles through,
+//  just itself if it doesn't animate.
+//
+void
+P_AnimTextureRange
+( int		texture,
+  int*		first,
+  int*		last )
+{
+    anim_t*	anim;
+
+    for (anim = anims ; anim < lastanim ; anim++)
+    {
+	if (anim->istexture
+	    && texture >= anim->basepic
+	    && texture <= anim->picnum)
+	{
+	    *first = anim->basepic;
+	    *last = anim->picnum;
+	    return;
+	}
+    }
+    *first = *last = texture;
+}
+
+
 
 //
 // UTILITIES
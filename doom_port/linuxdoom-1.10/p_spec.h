@@ -41,6 +41,12 @@ extern	int	levelTimeCount;
 // at game start
 void    P_InitPicAnims (void);
 
+void
+P_AnimTextureRange
+( int		texture,
+  int*		first,
+  int*		last );
+
 // at map load
 void    P_SpawnSpecials (void);
 
@@ -178,6 +184,7 @@ typedef struct
 #define FASTDARK			15
 #define SLOWDARK			35
 
+void    T_FireFlicker (fireflicker_t* flick);
 void    P_SpawnFireFlicker (sector_t* sector);
 void    T_LightFlash (lightflash_t* flash);
 void    P_SpawnLightFlash (sector_t* sector);
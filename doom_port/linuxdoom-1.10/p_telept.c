@@ -123,6 +123,14 @@ EV_Teleport
 
 		thing->angle = m->angle;
 		thing->momx = thing->momy = thing->momz = 0;
+
+		// snap the refresh, don't slide across the map
+		thing->oldx = thing->x;
+		thing->oldy = thing->y;
+		thing->oldz = thing->z;
+		thing->oldangle = thing->angle;
+		if (thing->player)
+		    thing->player->oldviewz = thing->player->viewz;
 		return 1;
 	    }	
 	}
@@ -25,6 +25,8 @@
 static const char
 rcsid[] = "$Id: p_tick.c,v 1.4 1997/02/03 16:47:55 b1 Exp $";
 
+#include <string.h>
+
 #include "z_zone.h"
 #include "p_local.h"
 
@@ -47,12 +49,64 @@ int	leveltime;
 thinker_t	thinkercap;
 
 
+//
+// Thinker classes.
+// Outside demos and netgames the thinkers run a class at a time,
+//  the same function over and over, each class in the order
+//  its thinkers were added. Thinkers added during the tic
+//  run after the classes, as they would have.
+// The list stays as it was for everything else that walks it.
+//
+typedef struct
+{
+    actionf_p1		function;
+    thinker_t**		list;
+    int			count;
+    int			max;
+
+} thinkerclass_t;
+
+static thinkerclass_t	thinkerclasses[] =
+{
+    { (actionf_p1)P_MobjThinker },
+    { (actionf_p1)T_VerticalDoor },
+    { (actionf_p1)T_MoveFloor },
+    { (actionf_p1)T_MoveCeiling },
+    { (actionf_p1)T_PlatRaise },
+    { (actionf_p1)T_LightFlash },
+    { (actionf_p1)T_StrobeFlash },
+    { (actionf_p1)T_Glow },
+    { (actionf_p1)T_FireFlicker },
+
+    // anything else, and ceilings and plats in stasis
+    { NULL }
+};
+
+#define NUMTHINKERCLASSES \
+	(int)(sizeof(thinkerclasses)/sizeof(*thinkerclasses))
+
+// dormant mobjs, out of the mobj class
+static thinkerclass_t	sleepers;
+
+boolean		globalthinkers;
+
+static boolean	classesdirty;		// list changed outside the classes
+static int	thinkerremovals;	// since the classes were swept
+static int	mobjsslept;		// since the classes were sorted
+static int	mobjswoken;
+static thinker_t*	lastclassified;	// the rest were added between runs
+
+
+
 //
 // P_InitThinkers
 //
 void P_InitThinkers (void)
 {
     thinkercap.prev = thinkercap.next  = &thinkercap;
+    classesdirty = true;
+    thinkerremovals = 0;
+    mobjsslept = mobjswoken = 0;
 }
 
 
@@ -81,6 +135,7 @@ void P_RemoveThinker (thinker_t* thinker)
 {
   // FIXME: NOP.
   thinker->function.acv = (actionf_v)(-1);
+  thinkerremovals++;
 }
 
 
@@ -95,13 +150,263 @@ void P_AllocateThinker (thinker_t*	thinker)
 
 
 
+//
+// P_SleepMobj
+// Called by P_MobjThinker when nothing it does
+//  can change the mobj any more.
+// The list walk skips it, the classes move it
+//  to the sleepers once the tic is done.
+//
+void P_SleepMobj (mobj_t* mobj)
+{
+    mobj->dormant = true;
+    mobjsslept++;
+}
+
+
+
+//
+// P_WakeMobj
+// Called for anything that acts on a mobj from outside,
+//  damage, sectors moving and new states.
+//
+void P_WakeMobj (mobj_t* mobj)
+{
+    if (!mobj->dormant)
+	return;
+
+    mobj->dormant = false;
+    mobjswoken++;
+}
+
+
+
+//
+// P_AddToClass
+//
+static void
+P_AddToClass
+( thinkerclass_t*	tc,
+  thinker_t*		th )
+{
+    thinker_t**		list;
+
+    if (tc->count == tc->max)
+    {
+	tc->max = tc->max ? tc->max*2 : 256;
+	list = Z_Malloc (tc->max*sizeof(*list), PU_STATIC, 0);
+	if (tc->list)
+	{
+	    memcpy (list, tc->list, tc->count*sizeof(*list));
+	    Z_Free (tc->list);
+	}
+	tc->list = list;
+    }
+    tc->list[tc->count++] = th;
+}
+
+
+
+//
+// P_ClassifyThinkers
+// Adds first through the end of the list
+//  to the classes, removed ones too,
+//  so P_SweepThinkers frees them.
+//
+static void P_ClassifyThinkers (thinker_t* first)
+{
+    thinkerclass_t*	tc;
+    thinker_t*		th;
+
+    for (th = first ; th != &thinkercap ; th = th->next)
+    {
+	for (tc = thinkerclasses ; tc->function ; tc++)
+	    if (th->function.acp1 == tc->function)
+		break;
+
+	if (tc == thinkerclasses && ((mobj_t *)th)->dormant)
+	    tc = &sleepers;
+	P_AddToClass (tc, th);
+    }
+}
+
+
+
+//
+// P_SortSleepers
+// Moves the mobjs that woke back to the mobj class,
+//  and those that fell asleep out of it.
+// Removing a mobj wakes it, so only the
+//  mobj class has to be swept.
+//
+static void P_SortSleepers (void)
+{
+    thinkerclass_t*	mobjs;
+    thinker_t*		th;
+    int			i;
+    int			j;
+
+    mobjs = &thinkerclasses[0];
+
+    if (mobjswoken)
+    {
+	for (i=j=0 ; i<sleepers.count ; i++)
+	{
+	    th = sleepers.list[i];
+	    if (((mobj_t *)th)->dormant)
+		sleepers.list[j++] = th;
+	    else
+		P_AddToClass (mobjs, th);
+	}
+	sleepers.count = j;
+    }
+
+    if (mobjsslept)
+    {
+	for (i=j=0 ; i<mobjs->count ; i++)
+	{
+	    th = mobjs->list[i];
+	    if (((mobj_t *)th)->dormant)
+		P_AddToClass (&sleepers, th);
+	    else
+		mobjs->list[j++] = th;
+	}
+	mobjs->count = j;
+    }
+
+    mobjsslept = mobjswoken = 0;
+}
+
+
+
+//
+// P_SweepThinkers
+// Unlinks and frees the removed thinkers,
+//  keeping the others in order.
+//
+static void P_SweepThinkers (void)
+{
+    thinkerclass_t*	tc;
+    thinker_t*		th;
+    int			i;
+    int			j;
+
+    for (tc = thinkerclasses ; tc < thinkerclasses+NUMTHINKERCLASSES ; tc++)
+    {
+	for (i=j=0 ; i<tc->count ; i++)
+	{
+	    th = tc->list[i];
+	    if (th->function.acv == (actionf_v)(-1))
+	    {
+		th->next->prev = th->prev;
+		th->prev->next = th->next;
+		Z_Free (th);
+	    }
+	    else
+		tc->list[j++] = th;
+	}
+	tc->count = j;
+    }
+    thinkerremovals = 0;
+}
+
+
+
+//
+// P_RunThinkerClasses
+// A removed thinker is left where it is until
+//  the tic is done, so the classes stay valid.
+//
+static void P_RunThinkerClasses (void)
+{
+    thinkerclass_t*	tc;
+    actionf_p1		function;
+    thinker_t**		list;
+    thinker_t*		last;
+    thinker_t*		th;
+    int			count;
+    int			i;
+
+    if (classesdirty)
+    {
+	for (tc = thinkerclasses ; tc < thinkerclasses+NUMTHINKERCLASSES ; tc++)
+	    tc->count = 0;
+	sleepers.count = 0;
+	P_ClassifyThinkers (thinkercap.next);
+	classesdirty = false;
+	mobjsslept = mobjswoken = 0;
+    }
+    else
+    {
+	// doors, missiles and respawns from outside the run
+	P_ClassifyThinkers (lastclassified->next);
+    }
+
+    // anything added from here on runs last
+    last = thinkercap.prev;
+
+    for (tc = thinkerclasses ; tc->function ; tc++)
+    {
+	function = tc->function;
+	list = tc->list;
+	count = tc->count;
+
+	// stasis and removal change the function
+	for (i=0 ; i<count ; i++)
+	    if (list[i]->function.acp1 == function)
+		function (list[i]);
+    }
+
+    list = tc->list;
+    count = tc->count;
+    for (i=0 ; i<count ; i++)
+    {
+	th = list[i];
+	if (th->function.acp1
+	    && th->function.acv != (actionf_v)(-1))
+	    th->function.acp1 (th);
+    }
+
+    for (th = last->next ; th != &thinkercap ; th = th->next)
+    {
+	if (th->function.acp1
+	    && th->function.acv != (actionf_v)(-1))
+	    th->function.acp1 (th);
+    }
+
+    P_ClassifyThinkers (last->next);
+    if (mobjsslept || mobjswoken)
+	P_SortSleepers ();
+    if (thinkerremovals)
+	P_SweepThinkers ();
+
+    // removal is only marked until the next sweep
+    lastclassified = thinkercap.prev;
+}
+
+
+
 //
 // P_RunThinkers
+// Demos and netgames need the order of the list,
+//  the classes change which thinker takes P_Random first.
 //
 void P_RunThinkers (void)
 {
     thinker_t*	currentthinker;
 
+    if (!globalthinkers
+	&& !demoplayback
+	&& !demorecording
+	&& !netgame)
+    {
+	P_RunThinkerClasses ();
+	return;
+    }
+
+    // frees thinkers the classes have
+    classesdirty = true;
+
     currentthinker = thinkercap.next;
     while (currentthinker != &thinkercap)
     {
@@ -112,9 +417,11 @@ void P_RunThinkers (void)
 	    currentthinker->prev->next = currentthinker->next;
 	    Z_Free (currentthinker);
 	}
-	else
+	else if (currentthinker->function.acp1)
 	{
-	    if (currentthinker->function.acp1)
+	    // dormant mobjs would do nothing
+	    if (currentthinker->function.acp1 != (actionf_p1)P_MobjThinker
+		|| !((mobj_t *)currentthinker)->dormant)
 		currentthinker->function.acp1 (currentthinker);
 	}
 	currentthinker = currentthinker->next;
@@ -123,6 +430,36 @@ void P_RunThinkers (void)
 
 
 
+//
+// P_SaveOldPositions
+// Remember where everything was before the tic runs,
+//  so the refresh can interpolate up to the new positions.
+// Done even when paused, so a frozen world stays still.
+//
+void P_SaveOldPositions (void)
+{
+    thinker_t*	th;
+    mobj_t*	mo;
+    int		i;
+
+    for (th = thinkercap.next ; th != &thinkercap ; th = th->next)
+    {
+	if (th->function.acp1 != (actionf_p1)P_MobjThinker)
+	    continue;
+	mo = (mobj_t *)th;
+	mo->oldx = mo->x;
+	mo->oldy = mo->y;
+	mo->oldz = mo->z;
+	mo->oldangle = mo->angle;
+    }
+
+    for (i=0 ; i<MAXPLAYERS ; i++)
+	if (playeringame[i])
+	    players[i].oldviewz = players[i].viewz;
+}
+
+
+
 //
 // P_Ticker
 //
@@ -131,6 +468,8 @@ void P_Ticker (void)
 {
     int		i;
     
+    P_SaveOldPositions ();
+
     // run the tic
     if (paused)
 	return;
@@ -145,6 +484,8 @@ void P_Ticker (void)
     }
     
 		
+    P_ClearSightCache ();
+
     for (i=0 ; i<MAXPLAYERS ; i++)
 	if (playeringame[i])
 	    P_PlayerThink (&players[i]);
@@ -26,6 +26,8 @@ static const char
 rcsid[] = "$Id: r_bsp.c,v 1.4 1997/02/03 22:45:12 b1 Exp $";
 
 
+#include <string.h>
+
 #include "doomdef.h"
 
 #include "m_bbox.h"
@@ -35,6 +37,7 @@ rcsid[] = "$Id: r_bsp.c,v 1.4 1997/02/03 22:45:12 b1 Exp $";
 #include "r_main.h"
 #include "r_plane.h"
 #include "r_things.h"
+#include "r_pvs.h"
 
 // State.
 #include "doomstat.h"
@@ -44,14 +47,14 @@ rcsid[] = "$Id: r_bsp.c,v 1.4 1997/02/03 22:45:12 b1 Exp $";
 
 
 
-seg_t*		curline;
-side_t*		sidedef;
-line_t*		linedef;
-sector_t*	frontsector;
-sector_t*	backsector;
+VIEWSTATE seg_t*		curline;
+VIEWSTATE side_t*		sidedef;
+VIEWSTATE line_t*		linedef;
+VIEWSTATE sector_t*	frontsector;
+VIEWSTATE sector_t*	backsector;
 
-drawseg_t	drawsegs[MAXDRAWSEGS];
-drawseg_t*	ds_p;
+VIEWSTATE drawseg_t	drawsegs[MAXDRAWSEGS];
+VIEWSTATE drawseg_t*	ds_p;
 
 
 void
@@ -88,8 +91,80 @@ typedef	struct
 #define MAXSEGS		32
 
 // newend is one past the last valid seg
-cliprange_t*	newend;
-cliprange_t	solidsegs[MAXSEGS];
+VIEWSTATE cliprange_t*	newend;
+VIEWSTATE cliprange_t	solidsegs[MAXSEGS];
+
+// The columns solidsegs covers, a bit each,
+//  so a covered range is a few word tests.
+#define SOLIDWORDS	((SCREENWIDTH+31)/32)
+
+VIEWSTATE unsigned	solidcols[SOLIDWORDS];
+
+
+
+//
+// R_SolidCovers
+// True if first through last are all behind solid walls.
+//
+static boolean
+R_SolidCovers
+( int		first,
+  int		last )
+{
+    int		w1;
+    int		w2;
+    unsigned	m1;
+    unsigned	m2;
+
+    w1 = first>>5;
+    w2 = last>>5;
+    m1 = ~0u << (first&31);
+    m2 = ~0u >> (31-(last&31));
+
+    if (w1 == w2)
+	return (solidcols[w1] & m1 & m2) == (m1 & m2);
+
+    if ((solidcols[w1] & m1) != m1
+	|| (solidcols[w2] & m2) != m2)
+	return false;
+
+    while (++w1 < w2)
+	if (solidcols[w1] != ~0u)
+	    return false;
+
+    return true;
+}
+
+
+//
+// R_MarkSolid
+//
+static void
+R_MarkSolid
+( int		first,
+  int		last )
+{
+    int		w1;
+    int		w2;
+    unsigned	m1;
+    unsigned	m2;
+
+    w1 = first>>5;
+    w2 = last>>5;
+    m1 = ~0u << (first&31);
+    m2 = ~0u >> (31-(last&31));
+
+    if (w1 == w2)
+    {
+	solidcols[w1] |= m1 & m2;
+	return;
+    }
+
+    solidcols[w1] |= m1;
+    while (++w1 < w2)
+	solidcols[w1] = ~0u;
+    solidcols[w2] |= m2;
+}
 
 
 
@@ -108,6 +183,11 @@ R_ClipSolidWallSegment
     cliprange_t*	next;
     cliprange_t*	start;
 
+    // Already hidden, nothing changes.
+    if (R_SolidCovers (first, last))
+	return;
+    R_MarkSolid (first, last);
+
     // Find the first range that touches the range
     //  (adjacent pixels are touching).
     start = solidsegs;
@@ -200,6 +280,9 @@ R_ClipPassWallSegment
 {
     cliprange_t*	start;
 
+    if (R_SolidCovers (first, last))
+	return;
+
     // Find the first range that touches the range
     //  (adjacent pixels are touching).
     start = solidsegs;
@@ -249,6 +332,7 @@ void R_ClearClipSegs (void)
     solidsegs[1].first = viewwidth;
     solidsegs[1].last = 0x7fffffff;
     newend = solidsegs+2;
+    memset (solidcols, 0, sizeof(solidcols));
 }
 
 //
@@ -267,6 +351,15 @@ void R_AddLine (seg_t*	line)
     
     curline = line;
 
+    // Distance from the view point to the line the seg is on,
+    //  along the normal, also needed by R_StoreWallRange.
+    // Negative means the back side faces the view,
+    //  no need for the angles then.
+    rw_distance = FixedMul (line->v1->y - viewy, line->dirx)
+		- FixedMul (line->v1->x - viewx, line->diry);
+    if (rw_distance < 0)
+	return;
+
     // OPTIMIZE: quickly reject orthogonal back sides.
     angle1 = R_PointToAngle (line->v1->x, line->v1->y);
     angle2 = R_PointToAngle (line->v2->x, line->v2->y);
@@ -317,7 +410,7 @@ void R_AddLine (seg_t*	line)
     if (x1 == x2)
 	return;				
 	
-    backsector = line->backsector;
+    backsector = line->backsector ? VIEWSECTOR(line->backsector) : NULL;
 
     // Single sided line?
     if (!backsector)
@@ -341,7 +434,7 @@ void R_AddLine (seg_t*	line)
     if (backsector->ceilingpic == frontsector->ceilingpic
 	&& backsector->floorpic == frontsector->floorpic
 	&& backsector->lightlevel == frontsector->lightlevel
-	&& curline->sidedef->midtexture == 0)
+	&& VIEWSIDE(curline->sidedef)->midtexture == 0)
     {
 	return;
     }
@@ -394,8 +487,6 @@ boolean R_CheckBBox (fixed_t*	bspcoord)
     angle_t		span;
     angle_t		tspan;
     
-    cliprange_t*	start;
-
     int			sx1;
     int			sx2;
     
@@ -459,9 +550,7 @@ boolean R_CheckBBox (fixed_t*	bspcoord)
     }
 
 
-    // Find the first clippost
-    //  that touches the source post
-    //  (adjacent pixels are touching).
+    // Find the columns the box spans.
     angle1 = (angle1+ANG90)>>ANGLETOFINESHIFT;
     angle2 = (angle2+ANG90)>>ANGLETOFINESHIFT;
     sx1 = viewangletox[angle1];
@@ -471,19 +560,10 @@ boolean R_CheckBBox (fixed_t*	bspcoord)
     if (sx1 == sx2)
 	return false;			
     sx2--;
-	
-    start = solidsegs;
-    while (start->last < sx2)
-	start++;
-    
-    if (sx1 >= start->first
-	&& sx2 <= start->last)
-    {
-	// The clippost contains the new span.
-	return false;
-    }
 
-    return true;
+    // Touching clipposts are merged, so this is
+    //  the same as one of them containing the span.
+    return !R_SolidCovers (sx1, sx2);
 }
 
 
@@ -509,7 +589,7 @@ void R_Subsector (int num)
 
     sscount++;
     sub = &subsectors[num];
-    frontsector = sub->sector;
+    frontsector = VIEWSECTOR(sub->sector);
     count = sub->numlines;
     line = &segs[sub->firstline];
 
@@ -547,34 +627,56 @@ void R_Subsector (int num)
 //
 // RenderBSPNode
 // Renders all subsectors below a given node,
-//  traversing subtree recursively.
+//  front to back, same order as the recursive walk,
+//  but with the pending back sides on an explicit stack.
+// Even with the whole view covered by solid walls, boxes
+//  round the viewpoint pass R_CheckBBox, and the sprites
+//  of their sectors still go in, so the walk goes on.
 // Just call with BSP root.
 void R_RenderBSPNode (int bspnum)
 {
+    int		stack[MAXBSPDEPTH];
+    int		sp;
     node_t*	bsp;
     int		side;
 
-    // Found a subsector?
-    if (bspnum & NF_SUBSECTOR)
+    sp = 0;
+    while (1)
     {
-	if (bspnum == -1)			
-	    R_Subsector (0);
-	else
-	    R_Subsector (bspnum&(~NF_SUBSECTOR));
-	return;
-    }
-		
-    bsp = &nodes[bspnum];
-    
-    // Decide which side the view point is on.
-    side = R_PointOnSide (viewx, viewy, bsp);
+	// Divide front space down to a subsector,
+	//  unless nothing down there can be seen from this sector.
+	while (R_NodeInPVS (bspnum))
+	{
+	    // Found a subsector?
+	    if (bspnum & NF_SUBSECTOR)
+	    {
+		if (bspnum == -1)
+		    R_Subsector (0);
+		else
+		    R_Subsector (bspnum&(~NF_SUBSECTOR));
+		break;
+	    }
 
-    // Recursively divide front space.
-    R_RenderBSPNode (bsp->children[side]); 
+	    bsp = &nodes[bspnum];
 
-    // Possibly divide back space.
-    if (R_CheckBBox (bsp->bbox[side^1]))	
-	R_RenderBSPNode (bsp->children[side^1]);
+	    // Decide which side the view point is on.
+	    side = R_PointOnSide (viewx, viewy, bsp);
+	    stack[sp++] = (bspnum<<1) | side;
+	    bspnum = bsp->children[side];
+	}
+
+	// Back up to the first back space that is possibly visible.
+	do
+	{
+	    if (!sp)
+		return;
+	    sp--;
+	    bsp = &nodes[stack[sp]>>1];
+	    side = stack[sp]&1;
+	} while (!R_CheckBBox (bsp->bbox[side^1]));
+
+	bspnum = bsp->children[side^1];
+    }
 }
 
 
@@ -28,25 +28,25 @@
 #endif
 
 
-extern seg_t*		curline;
-extern side_t*		sidedef;
-extern line_t*		linedef;
-extern sector_t*	frontsector;
-extern sector_t*	backsector;
+extern VIEWSTATE seg_t*		curline;
+extern VIEWSTATE side_t*		sidedef;
+extern VIEWSTATE line_t*		linedef;
+extern VIEWSTATE sector_t*	frontsector;
+extern VIEWSTATE sector_t*	backsector;
 
-extern int		rw_x;
-extern int		rw_stopx;
+extern VIEWSTATE int		rw_x;
+extern VIEWSTATE int		rw_stopx;
 
-extern boolean		segtextured;
+extern VIEWSTATE boolean		segtextured;
 
 // false if the back side is the same plane
-extern boolean		markfloor;		
-extern boolean		markceiling;
+extern VIEWSTATE boolean		markfloor;		
+extern VIEWSTATE boolean		markceiling;
 
 extern boolean		skymap;
 
-extern drawseg_t	drawsegs[MAXDRAWSEGS];
-extern drawseg_t*	ds_p;
+extern VIEWSTATE drawseg_t	drawsegs[MAXDRAWSEGS];
+extern VIEWSTATE drawseg_t*	ds_p;
 
 extern lighttable_t**	hscalelight;
 extern lighttable_t**	vscalelight;
@@ -45,6 +45,8 @@ rcsid[] = "$Id: r_data.c,v 1.4 1997/02/03 16:47:55 b1 Exp $";
 #include  <alloca.h>
 #endif
 
+#include <string.h>
+
 
 #include "r_data.h"
 
@@ -218,6 +220,9 @@ R_DrawColumnInCache
 }
 
 
+static void* R_HoldLumpLocked (int lump);
+static byte* R_HoldComposite (int tex);
+
 
 //
 // R_GenerateComposite
@@ -255,7 +260,10 @@ void R_GenerateComposite (int texnum)
 	 i<texture->patchcount;
 	 i++, patch++)
     {
-	realpatch = W_CacheLumpNum (patch->patch, PU_CACHE);
+	if (holdcache)
+	    realpatch = R_HoldLumpLocked (patch->patch);
+	else
+	    realpatch = W_CacheLumpNum (patch->patch, PU_CACHE);
 	x1 = patch->originx;
 	x2 = x1 + SHORT(realpatch->width);
 
@@ -392,7 +400,14 @@ R_GetColumn
     ofs = texturecolumnofs[tex][col];
     
     if (lump > 0)
+    {
+	if (holdcache)
+	    return (byte *)R_HoldLump(lump)+ofs;
 	return (byte *)W_CacheLumpNum(lump,PU_CACHE)+ofs;
+    }
+
+    if (holdcache)
+	return R_HoldComposite (tex) + ofs;
 
     if (!texturecomposite[tex])
 	R_GenerateComposite (tex);
@@ -403,6 +418,327 @@ R_GetColumn
 
 
 
+//
+// R_CachePatchNum
+// Patches are decoded the first time they are drawn,
+//  so the drawers never step over post headers
+//  or swap bytes.
+//
+static rpatch_t**	patchcache;
+
+rpatch_t* R_CachePatchNum (int lump)
+{
+    patch_t*	patch;
+    column_t*	column;
+    rpatch_t*	rpatch;
+    rcolumn_t*	rcolumn;
+    rpost_t*	rpost;
+    byte*	pixels;
+    int		tag;
+    int		width;
+    int		numposts;
+    int		numpixels;
+    int		x;
+
+    if (!patchcache)
+    {
+	patchcache = Z_Malloc (numlumps*sizeof(*patchcache), PU_STATIC, 0);
+	memset (patchcache, 0, numlumps*sizeof(*patchcache));
+    }
+
+    if (patchcache[lump])
+	return patchcache[lump];
+
+    // Hold the lump while the decoded copy is allocated,
+    //  the caller may still be using it.
+    tag = PU_CACHE;
+    if (lumpcache[lump])
+	tag = ((memblock_t *)((byte *)lumpcache[lump]
+			      - sizeof(memblock_t)))->tag;
+    patch = W_CacheLumpNum (lump, PU_STATIC);
+    width = SHORT(patch->width);
+
+    numposts = 0;
+    numpixels = 0;
+    for (x=0 ; x<width ; x++)
+    {
+	column = (column_t *)((byte *)patch + LONG(patch->columnofs[x]));
+	while (column->topdelta != 0xff)
+	{
+	    numposts++;
+	    numpixels += column->length;
+	    column = (column_t *)((byte *)column + column->length + 4);
+	}
+    }
+
+    rpatch = Z_Malloc (sizeof(rpatch_t) + (width-1)*sizeof(rcolumn_t)
+		       + numposts*sizeof(rpost_t) + numpixels,
+		       PU_CACHE, &patchcache[lump]);
+    rpatch->width = width;
+    rpatch->height = SHORT(patch->height);
+    rpatch->leftoffset = SHORT(patch->leftoffset);
+    rpatch->topoffset = SHORT(patch->topoffset);
+
+    rpost = (rpost_t *)&rpatch->columns[width];
+    pixels = (byte *)(rpost + numposts);
+    for (x=0, rcolumn=rpatch->columns ; x<width ; x++, rcolumn++)
+    {
+	rcolumn->numposts = 0;
+	rcolumn->posts = rpost;
+
+	column = (column_t *)((byte *)patch + LONG(patch->columnofs[x]));
+	while (column->topdelta != 0xff)
+	{
+	    rpost->topdelta = column->topdelta;
+	    rpost->length = column->length;
+	    rpost->pixels = pixels;
+	    memcpy (pixels, (byte *)column + 3, column->length);
+	    pixels += column->length;
+	    rpost++;
+	    rcolumn->numposts++;
+	    column = (column_t *)((byte *)column + column->length + 4);
+	}
+    }
+
+    Z_ChangeTag (patch, tag);
+    return rpatch;
+}
+
+
+//
+// R_PeekPatch
+// The screen drawers can't allocate, the caller may
+//  hold other PU_CACHE patches the zone would purge.
+// A patch not decoded yet is drawn as it is and
+//  waits for R_DecodeWaitingPatches.
+//
+#define MAXPATCHWAITS	64
+
+static int	patchwaits[MAXPATCHWAITS];
+static int	numpatchwaits;
+
+rpatch_t* R_PeekPatch (patch_t* patch)
+{
+    int		lump;
+    int		i;
+
+    lump = W_LumpNumForCache (patch);
+    if (lump == -1)
+	I_Error ("R_PeekPatch: not a cached lump");
+
+    if (patchcache && patchcache[lump])
+	return patchcache[lump];
+
+    for (i=0 ; i<numpatchwaits ; i++)
+	if (patchwaits[i] == lump)
+	    return NULL;
+    if (numpatchwaits < MAXPATCHWAITS)
+	patchwaits[numpatchwaits++] = lump;
+    return NULL;
+}
+
+
+//
+// R_DecodeWaitingPatches
+//
+void R_DecodeWaitingPatches (void)
+{
+    int		i;
+
+    for (i=0 ; i<numpatchwaits ; i++)
+	R_CachePatchNum (patchwaits[i]);
+    numpatchwaits = 0;
+}
+
+
+//
+// R_DecodeColumn
+// Masked mid textures come a column at a time
+//  out of R_GetColumn, decode just that.
+//
+#define MAXDECODEPOSTS	128
+
+rcolumn_t* R_DecodeColumn (column_t* column)
+{
+    static VIEWSTATE rpost_t	posts[MAXDECODEPOSTS];
+    static VIEWSTATE rcolumn_t	rcolumn;
+    rpost_t*			rpost;
+
+    rcolumn.numposts = 0;
+    rcolumn.posts = rpost = posts;
+    while (column->topdelta != 0xff
+	   && rcolumn.numposts < MAXDECODEPOSTS)
+    {
+	rpost->topdelta = column->topdelta;
+	rpost->length = column->length;
+	rpost->pixels = (byte *)column + 3;
+	rpost++;
+	rcolumn.numposts++;
+	column = (column_t *)((byte *)column + column->length + 4);
+    }
+    return &rcolumn;
+}
+
+
+
+
+//
+// Held caching.
+// While views are drawn on other threads,
+//  whatever they pull into zone memory is raised to PU_LEVEL,
+//  so no thread's allocation can purge what another is reading.
+// Only the first touch of each lump takes the zone lock.
+//
+boolean			holdcache;
+
+// The tag each held block had, 0 if it isn't held.
+static byte*		heldlumps;
+static byte*		heldpatches;
+static byte*		heldtextures;
+
+#define BLOCKTAG(ptr) \
+    (((memblock_t *)((byte *)(ptr) - sizeof(memblock_t)))->tag)
+
+#define ISHELD(held,i)		__atomic_load_n (&(held)[i], __ATOMIC_ACQUIRE)
+#define SETHELD(held,i,tag)	__atomic_store_n (&(held)[i], (tag), __ATOMIC_RELEASE)
+
+
+//
+// R_HoldBlock
+// Returns the tag to put back.
+//
+static int R_HoldBlock (void* ptr)
+{
+    int		tag;
+
+    tag = BLOCKTAG(ptr);
+    if (tag >= PU_PURGELEVEL)
+	Z_ChangeTag (ptr, PU_LEVEL);
+    return tag;
+}
+
+
+//
+// R_HoldLumpLocked
+// For callers that already have the zone lock.
+//
+static void* R_HoldLumpLocked (int lump)
+{
+    int		tag;
+
+    if (heldlumps[lump])
+	return lumpcache[lump];
+
+    tag = PU_CACHE;
+    if (lumpcache[lump])
+	tag = BLOCKTAG(lumpcache[lump]);
+    W_CacheLumpNum (lump, tag < PU_PURGELEVEL ? tag : PU_LEVEL);
+    SETHELD (heldlumps, lump, tag);
+    return lumpcache[lump];
+}
+
+
+//
+// R_HoldLump
+//
+void* R_HoldLump (int lump)
+{
+    if (!ISHELD (heldlumps, lump))
+    {
+	Z_Lock ();
+	R_HoldLumpLocked (lump);
+	Z_Unlock ();
+    }
+    return lumpcache[lump];
+}
+
+
+//
+// R_HoldComposite
+//
+static byte* R_HoldComposite (int tex)
+{
+    if (!ISHELD (heldtextures, tex))
+    {
+	Z_Lock ();
+	if (!heldtextures[tex])
+	{
+	    if (!texturecomposite[tex])
+		R_GenerateComposite (tex);
+	    SETHELD (heldtextures, tex, R_HoldBlock (texturecomposite[tex]));
+	}
+	Z_Unlock ();
+    }
+    return texturecomposite[tex];
+}
+
+
+//
+// R_HoldPatchNum
+//
+rpatch_t* R_HoldPatchNum (int lump)
+{
+    if (!ISHELD (heldpatches, lump))
+    {
+	Z_Lock ();
+	if (!heldpatches[lump])
+	    SETHELD (heldpatches, lump, R_HoldBlock (R_CachePatchNum (lump)));
+	Z_Unlock ();
+    }
+    return patchcache[lump];
+}
+
+
+//
+// R_HoldCache
+//
+void R_HoldCache (void)
+{
+    if (!heldlumps)
+    {
+	heldlumps = Z_Malloc (numlumps, PU_STATIC, 0);
+	heldpatches = Z_Malloc (numlumps, PU_STATIC, 0);
+	heldtextures = Z_Malloc (numtextures, PU_STATIC, 0);
+	memset (heldlumps, 0, numlumps);
+	memset (heldpatches, 0, numlumps);
+	memset (heldtextures, 0, numtextures);
+    }
+    holdcache = true;
+}
+
+
+//
+// R_ReleaseCache
+// Puts the tags back once the threads are done,
+//  so held blocks are purgable again between frames.
+//
+void R_ReleaseCache (void)
+{
+    int		i;
+
+    holdcache = false;
+
+    for (i=0 ; i<numlumps ; i++)
+    {
+	if (heldlumps[i] >= PU_PURGELEVEL)
+	    Z_ChangeTag (lumpcache[i], heldlumps[i]);
+	if (heldpatches[i] >= PU_PURGELEVEL)
+	    Z_ChangeTag (patchcache[i], heldpatches[i]);
+    }
+    for (i=0 ; i<numtextures ; i++)
+    {
+	if (heldtextures[i] >= PU_PURGELEVEL)
+	    Z_ChangeTag (texturecomposite[i], heldtextures[i]);
+    }
+
+    memset (heldlumps, 0, numlumps);
+    memset (heldpatches, 0, numlumps);
+    memset (heldtextures, 0, numtextures);
+}
+
+
+
+
 //
 // R_InitTextures
 // Initializes the texture list
@@ -38,6 +38,35 @@ R_GetColumn
   int		col );
 
 
+// Patches decoded for drawing. Purgable like PU_CACHE.
+rpatch_t* R_CachePatchNum (int lump);
+
+// The decoded form of a W_CacheLumpNum pointer, without
+//  allocating. NULL if it isn't decoded yet, it will be
+//  by the next R_DecodeWaitingPatches.
+rpatch_t* R_PeekPatch (patch_t* patch);
+
+// Called by D_Display before anything is drawn.
+void R_DecodeWaitingPatches (void);
+
+// A single column out of R_GetColumn,
+//  good until the next call on the same thread.
+rcolumn_t* R_DecodeColumn (column_t* column);
+
+
+// Set between R_HoldCache and R_ReleaseCache,
+//  while views are drawn on several threads.
+// Everything the drawers load stays put
+//  until R_ReleaseCache.
+extern boolean	holdcache;
+
+void R_HoldCache (void);
+void R_ReleaseCache (void);
+
+void* R_HoldLump (int lump);
+rpatch_t* R_HoldPatchNum (int lump);
+
+
 // I/O, setting up the stuff.
 void R_InitData (void);
 void R_PrecacheLevel (void);
@@ -55,6 +55,16 @@
 #define MAXDRAWSEGS		256
 
 
+// Refresh state that belongs to the view being drawn.
+// Every thread drawing a view has its own copy,
+//  see R_RenderViews.
+#ifdef __GNUC__
+#define VIEWSTATE	__thread
+#else
+#define VIEWSTATE
+#endif
+
+
 
 
 
@@ -131,6 +141,10 @@ typedef	struct
 
     int			linecount;
     struct line_s**	lines;	// [linecount] size
+
+    // Set by T_MovePlane, cleared once the automap
+    //  has looked at the lines again.
+    boolean		planesmoved;
     
 } sector_t;
 
@@ -254,6 +268,12 @@ typedef struct
     // backsector is NULL for one sided lines
     sector_t*	frontsector;
     sector_t*	backsector;
+
+    // Unit vector from v1 to v2, set up by P_LoadSegs,
+    //  so the wall setup is a few FixedMuls
+    //  instead of angle and distance lookups.
+    fixed_t	dirx;
+    fixed_t	diry;
     
 } seg_t;
 
@@ -278,6 +298,11 @@ typedef struct
     
 } node_t;
 
+// Deepest BSP tree P_SetupLevel accepts.
+// The traversals keep their own stacks this deep,
+//  one entry per node, bspnum<<1 | side taken.
+#define MAXBSPDEPTH	1024
+
 
 
 
@@ -364,6 +389,38 @@ typedef struct
 } patch_t;
 
 
+//
+// A patch as decoded by R_CachePatchNum.
+// Native byte order, aligned, and the columns
+//  point straight at their posts and pixels.
+//
+typedef struct
+{
+    int		topdelta;
+    int		length;
+    byte*	pixels;
+    
+} rpost_t;
+
+typedef struct
+{
+    int		numposts;
+    rpost_t*	posts;
+    
+} rcolumn_t;
+
+typedef struct
+{
+    int		width;
+    int		height;
+    int		leftoffset;
+    int		topoffset;
+    rcolumn_t	columns[1];	// [width]
+    // the posts and pixels follow
+    
+} rpatch_t;
+
+
 
 
 
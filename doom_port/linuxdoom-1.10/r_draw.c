@@ -27,10 +27,13 @@
 static const char
 rcsid[] = "$Id: r_draw.c,v 1.4 1997/02/03 16:47:55 b1 Exp $";
 
+#include <stdio.h>
+#include <string.h>
 
 #include "doomdef.h"
 
 #include "i_system.h"
+#include "m_argv.h"
 #include "z_zone.h"
 #include "w_wad.h"
 
@@ -64,10 +67,17 @@ byte*		viewimage;
 int		viewwidth;
 int		scaledviewwidth;
 int		viewheight;
+int		scaledviewheight;
 int		viewwindowx;
 int		viewwindowy; 
-byte*		ylookup[MAXHEIGHT]; 
-int		columnofs[MAXWIDTH]; 
+VIEWSTATE byte*		ylookup[MAXHEIGHT]; 
+VIEWSTATE int		columnofs[MAXWIDTH]; 
+
+// Below full scale the view is drawn here first,
+//  then stretched into the window.
+byte*		scalebuffer;
+int		scalecolumns[MAXWIDTH];
+int		scalerows[MAXHEIGHT];
 
 // Color tables for different players,
 //  translate a limited part to another
@@ -82,18 +92,21 @@ byte		translations[3][256];
 // R_DrawColumn
 // Source is the top of the column to scale.
 //
-lighttable_t*		dc_colormap; 
-int			dc_x; 
-int			dc_yl; 
-int			dc_yh; 
-fixed_t			dc_iscale; 
-fixed_t			dc_texturemid;
+VIEWSTATE lighttable_t*		dc_colormap; 
+VIEWSTATE int			dc_x; 
+VIEWSTATE int			dc_yl; 
+VIEWSTATE int			dc_yh; 
+VIEWSTATE fixed_t			dc_iscale; 
+VIEWSTATE fixed_t			dc_texturemid;
 
 // first pixel in a column (possibly virtual) 
-byte*			dc_source;		
+VIEWSTATE byte*			dc_source;		
+
+// mip level of dc_source, for the mip drawers
+VIEWSTATE int			dc_mip;
 
-// just for profiling 
-int			dccount;
+// just for profiling, pixels drawn by the column drawers
+VIEWSTATE int			dccount;
 
 //
 // A column is a vertical slice/span from a wall texture that,
@@ -126,6 +139,7 @@ void R_DrawColumn (void)
     // Use ylookup LUT to avoid multiply with ScreenWidth.
     // Use columnofs LUT for subwindows? 
     dest = ylookup[dc_yl] + columnofs[dc_x];  
+    dccount += count+1;
 
     // Determine scaling,
     //  which is the only mapping to be done.
@@ -230,8 +244,9 @@ void R_DrawColumnLow (void)
 	
 	I_Error ("R_DrawColumn: %i to %i at %i", dc_yl, dc_yh, dc_x);
     }
-    //	dccount++; 
 #endif 
+    dccount += (count+1)<<1;
+
     // Blocky mode, need to multiply by 2.
     dc_x <<= 1;
     
@@ -253,6 +268,230 @@ void R_DrawColumnLow (void)
 }
 
 
+
+//
+// R_DrawSkyColumn
+// Just a copy, R_SkyColumn has done the scaling
+//  and the colormap.
+//
+void R_DrawSkyColumn (void) 
+{ 
+    int			count; 
+    byte*		source;
+    byte*		dest; 
+ 
+    count = dc_yh - dc_yl; 
+    if (count < 0) 
+	return; 
+				 
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT) 
+	I_Error ("R_DrawSkyColumn: %i to %i at %i", dc_yl, dc_yh, dc_x); 
+#endif 
+
+    dest = ylookup[dc_yl] + columnofs[dc_x];  
+    source = dc_source + dc_yl;
+    dccount += count+1;
+
+    do 
+    {
+	*dest = *source++;
+	dest += SCREENWIDTH; 
+    } while (count--); 
+} 
+
+
+void R_DrawSkyColumnLow (void) 
+{ 
+    int			count; 
+    byte*		source;
+    byte*		dest; 
+    byte*		dest2;
+ 
+    count = dc_yh - dc_yl; 
+    if (count < 0) 
+	return; 
+				 
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT) 
+	I_Error ("R_DrawSkyColumn: %i to %i at %i", dc_yl, dc_yh, dc_x); 
+#endif 
+    dccount += (count+1)<<1;
+
+    dest = ylookup[dc_yl] + columnofs[dc_x<<1];
+    dest2 = ylookup[dc_yl] + columnofs[(dc_x<<1)+1];
+    source = dc_source + dc_yl;
+
+    do 
+    {
+	*dest2 = *dest = *source++;
+	dest += SCREENWIDTH;
+	dest2 += SCREENWIDTH;
+    } while (count--);
+}
+
+
+
+//
+// R_DrawLitColumn
+// R_DrawColumn without the colormap.
+//
+void R_DrawLitColumn (void) 
+{ 
+    int			count; 
+    byte*		dest; 
+    fixed_t		frac;
+    fixed_t		fracstep;	 
+ 
+    count = dc_yh - dc_yl; 
+    if (count < 0) 
+	return; 
+				 
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT) 
+	I_Error ("R_DrawLitColumn: %i to %i at %i", dc_yl, dc_yh, dc_x); 
+#endif 
+
+    dest = ylookup[dc_yl] + columnofs[dc_x];  
+    dccount += count+1;
+
+    fracstep = dc_iscale; 
+    frac = dc_texturemid + (dc_yl-centery)*fracstep; 
+
+    do 
+    {
+	*dest = dc_source[(frac>>FRACBITS)&127];
+	dest += SCREENWIDTH; 
+	frac += fracstep;
+    } while (count--); 
+} 
+
+
+void R_DrawLitColumnLow (void) 
+{ 
+    int			count; 
+    byte*		dest; 
+    byte*		dest2;
+    fixed_t		frac;
+    fixed_t		fracstep;	 
+ 
+    count = dc_yh - dc_yl; 
+    if (count < 0) 
+	return; 
+				 
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT) 
+	I_Error ("R_DrawLitColumn: %i to %i at %i", dc_yl, dc_yh, dc_x); 
+#endif 
+    dccount += (count+1)<<1;
+
+    dest = ylookup[dc_yl] + columnofs[dc_x<<1];
+    dest2 = ylookup[dc_yl] + columnofs[(dc_x<<1)+1];
+    
+    fracstep = dc_iscale; 
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+    
+    do 
+    {
+	*dest2 = *dest = dc_source[(frac>>FRACBITS)&127];
+	dest += SCREENWIDTH;
+	dest2 += SCREENWIDTH;
+	frac += fracstep; 
+    } while (count--);
+}
+
+
+
+//
+// R_DrawColumnMip
+// R_DrawColumn on a mip level, the fracs
+//  are still in texels of the texture.
+//
+void R_DrawColumnMip (void) 
+{ 
+    int			count; 
+    byte*		dest; 
+    fixed_t		frac;
+    fixed_t		fracstep;	 
+    int			shift;
+    int			mask;
+ 
+    count = dc_yh - dc_yl; 
+    if (count < 0) 
+	return; 
+				 
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT) 
+	I_Error ("R_DrawColumnMip: %i to %i at %i", dc_yl, dc_yh, dc_x); 
+#endif 
+
+    dest = ylookup[dc_yl] + columnofs[dc_x];  
+    dccount += count+1;
+
+    shift = FRACBITS+dc_mip;
+    mask = 127>>dc_mip;
+    fracstep = dc_iscale; 
+    frac = dc_texturemid + (dc_yl-centery)*fracstep; 
+
+    do 
+    {
+	*dest = dc_colormap[dc_source[(frac>>shift)&mask]];
+	dest += SCREENWIDTH; 
+	frac += fracstep;
+    } while (count--); 
+} 
+
+
+void R_DrawColumnMipLow (void) 
+{ 
+    int			count; 
+    byte*		dest; 
+    byte*		dest2;
+    fixed_t		frac;
+    fixed_t		fracstep;	 
+    int			shift;
+    int			mask;
+ 
+    count = dc_yh - dc_yl; 
+    if (count < 0) 
+	return; 
+				 
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT) 
+	I_Error ("R_DrawColumnMip: %i to %i at %i", dc_yl, dc_yh, dc_x); 
+#endif 
+    dccount += (count+1)<<1;
+
+    dest = ylookup[dc_yl] + columnofs[dc_x<<1];
+    dest2 = ylookup[dc_yl] + columnofs[(dc_x<<1)+1];
+    
+    shift = FRACBITS+dc_mip;
+    mask = 127>>dc_mip;
+    fracstep = dc_iscale; 
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+    
+    do 
+    {
+	*dest2 = *dest = dc_colormap[dc_source[(frac>>shift)&mask]];
+	dest += SCREENWIDTH;
+	dest2 += SCREENWIDTH;
+	frac += fracstep; 
+    } while (count--);
+}
+
+
 //
 // Spectre/Invisibility.
 //
@@ -271,7 +510,23 @@ int	fuzzoffset[FUZZTABLE] =
     FUZZOFF,FUZZOFF,-FUZZOFF,FUZZOFF,FUZZOFF,-FUZZOFF,FUZZOFF 
 }; 
 
-int	fuzzpos = 0; 
+VIEWSTATE int	fuzzpos = 0; 
+
+// fuzzoffset with the start repeated after the end,
+//  so four from any fuzzpos can be loaded at once
+static int	fuzzrun[FUZZTABLE+3];
+
+
+//
+// R_InitFuzzRun
+//
+static void R_InitFuzzRun (void)
+{
+    int		i;
+
+    for (i=0 ; i<FUZZTABLE+3 ; i++)
+	fuzzrun[i] = fuzzoffset[i%FUZZTABLE];
+}
 
 
 //
@@ -341,6 +596,7 @@ void R_DrawFuzzColumn (void)
     
     // Does not work with blocky mode.
     dest = ylookup[dc_yl] + columnofs[dc_x];
+    dccount += count+1;
 
     // Looks familiar.
     fracstep = dc_iscale; 
@@ -379,7 +635,7 @@ void R_DrawFuzzColumn (void)
 //  of the BaronOfHell, the HellKnight, uses
 //  identical sprites, kinda brightened up.
 //
-byte*	dc_translation;
+VIEWSTATE byte*	dc_translation;
 byte*	translationtables;
 
 void R_DrawTranslatedColumn (void) 
@@ -426,6 +682,7 @@ void R_DrawTranslatedColumn (void)
     
     // FIXME. As above.
     dest = ylookup[dc_yl] + columnofs[dc_x]; 
+    dccount += count+1;
 
     // Looks familiar.
     fracstep = dc_iscale; 
@@ -497,22 +754,25 @@ void R_InitTranslationTables (void)
 // In consequence, flats are not stored by column (like walls),
 //  and the inner loop has to step in texture space u and v.
 //
-int			ds_y; 
-int			ds_x1; 
-int			ds_x2;
+VIEWSTATE int			ds_y; 
+VIEWSTATE int			ds_x1; 
+VIEWSTATE int			ds_x2;
 
-lighttable_t*		ds_colormap; 
+VIEWSTATE lighttable_t*		ds_colormap; 
 
-fixed_t			ds_xfrac; 
-fixed_t			ds_yfrac; 
-fixed_t			ds_xstep; 
-fixed_t			ds_ystep;
+VIEWSTATE fixed_t			ds_xfrac; 
+VIEWSTATE fixed_t			ds_yfrac; 
+VIEWSTATE fixed_t			ds_xstep; 
+VIEWSTATE fixed_t			ds_ystep;
 
 // start of a 64*64 tile image 
-byte*			ds_source;	
+VIEWSTATE byte*			ds_source;	
 
-// just for profiling
-int			dscount;
+// for the mip drawers, ds_source is (64>>ds_mip) square
+VIEWSTATE int			ds_mip;
+
+// just for profiling, pixels drawn by the span drawers
+VIEWSTATE int			dscount;
 
 
 //
@@ -545,6 +805,7 @@ void R_DrawSpan (void)
 
     // We do not check for zero spans here?
     count = ds_x2 - ds_x1; 
+    dscount += count+1;
 
     do 
     {
@@ -671,6 +932,7 @@ void R_DrawSpanLow (void)
   
     
     count = ds_x2 - ds_x1; 
+    dscount += (count+1)<<1;
     do 
     { 
 	spot = ((yfrac>>(16-6))&(63*64)) + ((xfrac>>16)&63);
@@ -685,54 +947,796 @@ void R_DrawSpanLow (void)
     } while (count--); 
 }
 
+
+
 //
-// R_InitBuffer 
-// Creats lookup tables that avoid
-//  multiplies and other hazzles
-//  for getting the framebuffer address
-//  of a pixel to draw.
+// R_DrawSpanMip
+// R_DrawSpan on a mip level, the fracs
+//  are still in texels of the flat.
 //
-void
-R_InitBuffer
-( int		width,
-  int		height ) 
+void R_DrawSpanMip (void) 
 { 
-    int		i; 
-
-    // Handle resize,
-    //  e.g. smaller view windows
-    //  with border and/or status bar.
-    viewwindowx = (SCREENWIDTH-width) >> 1; 
-
-    // Column offset. For windows.
-    for (i=0 ; i<width ; i++) 
-	columnofs[i] = viewwindowx + i;
+    fixed_t		xfrac;
+    fixed_t		yfrac; 
+    byte*		dest; 
+    int			count;
+    int			spot; 
+    int			shift;
+    int			bits;
+    int			mask;
+	 
+#ifdef RANGECHECK 
+    if (ds_x2 < ds_x1
+	|| ds_x1<0
+	|| ds_x2>=SCREENWIDTH  
+	|| (unsigned)ds_y>SCREENHEIGHT)
+    {
+	I_Error( "R_DrawSpanMip: %i to %i at %i",
+		 ds_x1,ds_x2,ds_y);
+    }
+#endif 
 
-    // Samw with base row offset.
-    if (width == SCREENWIDTH) 
-	viewwindowy = 0; 
-    else 
-	viewwindowy = (SCREENHEIGHT-SBARHEIGHT-height) >> 1; 
+    xfrac = ds_xfrac; 
+    yfrac = ds_yfrac; 
+	 
+    dest = ylookup[ds_y] + columnofs[ds_x1];
+    count = ds_x2 - ds_x1; 
+    dscount += count+1;
 
-    // Preclaculate all row offsets.
-    for (i=0 ; i<height ; i++) 
-	ylookup[i] = screens[0] + (i+viewwindowy)*SCREENWIDTH; 
+    shift = FRACBITS+ds_mip;
+    bits = 6-ds_mip;
+    mask = 63>>ds_mip;
+    do 
+    {
+	spot = (((yfrac>>shift)&mask)<<bits) + ((xfrac>>shift)&mask);
+	*dest++ = ds_colormap[ds_source[spot]];
+	xfrac += ds_xstep; 
+	yfrac += ds_ystep;
+    } while (count--); 
 } 
- 
- 
 
 
-//
-// R_FillBackScreen
-// Fills the back screen with a pattern
-//  for variable screen sizes
-// Also draws a beveled edge.
-//
-void R_FillBackScreen (void) 
+void R_DrawSpanMipLow (void) 
 { 
-    byte*	src;
-    byte*	dest; 
-    int		x;
+    fixed_t		xfrac;
+    fixed_t		yfrac; 
+    byte*		dest; 
+    int			count;
+    int			spot; 
+    int			shift;
+    int			bits;
+    int			mask;
+	 
+#ifdef RANGECHECK 
+    if (ds_x2 < ds_x1
+	|| ds_x1<0
+	|| ds_x2>=SCREENWIDTH  
+	|| (unsigned)ds_y>SCREENHEIGHT)
+    {
+	I_Error( "R_DrawSpanMip: %i to %i at %i",
+		 ds_x1,ds_x2,ds_y);
+    }
+#endif 
+
+    xfrac = ds_xfrac; 
+    yfrac = ds_yfrac; 
+
+    dest = ylookup[ds_y] + columnofs[ds_x1<<1];
+    count = ds_x2 - ds_x1; 
+    dscount += (count+1)<<1;
+
+    shift = FRACBITS+ds_mip;
+    bits = 6-ds_mip;
+    mask = 63>>ds_mip;
+    do 
+    { 
+	spot = (((yfrac>>shift)&mask)<<bits) + ((xfrac>>shift)&mask);
+	*dest++ = ds_colormap[ds_source[spot]]; 
+	*dest++ = ds_colormap[ds_source[spot]];
+	xfrac += ds_xstep; 
+	yfrac += ds_ystep; 
+    } while (count--); 
+}
+
+
+
+#ifdef CPU_X86
+#include <immintrin.h>
+
+//
+// R_DrawColumnSSE2
+// Steps four texels at a time,
+//  the lookups and stores are still one by one.
+//
+__attribute__ ((target ("sse2")))
+void R_DrawColumnSSE2 (void)
+{
+    int			count;
+    byte*		dest;
+    byte*		source;
+    lighttable_t*	colormap;
+    unsigned		frac;
+    unsigned		fracstep;
+    __m128i		vfrac;
+    __m128i		vstep;
+    __m128i		mask;
+    unsigned		idx[4] __attribute__ ((aligned (16)));
+
+    count = dc_yh - dc_yl;
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+	I_Error ("R_DrawColumn: %i to %i at %i", dc_yl, dc_yh, dc_x);
+#endif
+
+    dest = ylookup[dc_yl] + columnofs[dc_x];
+    dccount += count+1;
+    count++;
+
+    source = dc_source;
+    colormap = dc_colormap;
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*dc_iscale;
+
+    vfrac = _mm_set_epi32 (frac+fracstep*3, frac+fracstep*2,
+			   frac+fracstep, frac);
+    vstep = _mm_set1_epi32 (fracstep*4);
+    mask = _mm_set1_epi32 (127);
+
+    for ( ; count >= 4 ; count -= 4)
+    {
+	_mm_store_si128 ((__m128i *)idx,
+			 _mm_and_si128 (_mm_srli_epi32 (vfrac, FRACBITS), mask));
+	dest[0] = colormap[source[idx[0]]];
+	dest[SCREENWIDTH] = colormap[source[idx[1]]];
+	dest[SCREENWIDTH*2] = colormap[source[idx[2]]];
+	dest[SCREENWIDTH*3] = colormap[source[idx[3]]];
+	dest += SCREENWIDTH*4;
+	vfrac = _mm_add_epi32 (vfrac, vstep);
+    }
+
+    frac = _mm_cvtsi128_si32 (vfrac);
+    for ( ; count ; count--)
+    {
+	*dest = colormap[source[(frac>>FRACBITS)&127]];
+	dest += SCREENWIDTH;
+	frac += fracstep;
+    }
+}
+
+
+//
+// R_DrawSpanSSE2
+// Four spots at a time, stored as one word.
+//
+__attribute__ ((target ("sse2")))
+void R_DrawSpanSSE2 (void)
+{
+    int			count;
+    byte*		dest;
+    byte*		source;
+    lighttable_t*	colormap;
+    unsigned		xfrac;
+    unsigned		yfrac;
+    unsigned		four;
+    __m128i		vx;
+    __m128i		vy;
+    __m128i		vxstep;
+    __m128i		vystep;
+    __m128i		xmask;
+    __m128i		ymask;
+    unsigned		spot[4] __attribute__ ((aligned (16)));
+
+#ifdef RANGECHECK
+    if (ds_x2 < ds_x1
+	|| ds_x1<0
+	|| ds_x2>=SCREENWIDTH
+	|| (unsigned)ds_y>SCREENHEIGHT)
+    {
+	I_Error( "R_DrawSpan: %i to %i at %i",
+		 ds_x1,ds_x2,ds_y);
+    }
+#endif
+
+    dest = ylookup[ds_y] + columnofs[ds_x1];
+    count = ds_x2 - ds_x1 + 1;
+    dscount += count;
+
+    source = ds_source;
+    colormap = ds_colormap;
+    xfrac = ds_xfrac;
+    yfrac = ds_yfrac;
+
+    vx = _mm_set_epi32 (xfrac+ds_xstep*3, xfrac+ds_xstep*2,
+			xfrac+ds_xstep, xfrac);
+    vy = _mm_set_epi32 (yfrac+ds_ystep*3, yfrac+ds_ystep*2,
+			yfrac+ds_ystep, yfrac);
+    vxstep = _mm_set1_epi32 (ds_xstep*4);
+    vystep = _mm_set1_epi32 (ds_ystep*4);
+    xmask = _mm_set1_epi32 (63);
+    ymask = _mm_set1_epi32 (63*64);
+
+    for ( ; count >= 4 ; count -= 4)
+    {
+	_mm_store_si128 ((__m128i *)spot,
+			 _mm_or_si128 (_mm_and_si128 (_mm_srli_epi32 (vy, 16-6),
+						      ymask),
+				       _mm_and_si128 (_mm_srli_epi32 (vx, 16),
+						      xmask)));
+	four = colormap[source[spot[0]]]
+	    | (colormap[source[spot[1]]]<<8)
+	    | (colormap[source[spot[2]]]<<16)
+	    | ((unsigned)colormap[source[spot[3]]]<<24);
+	memcpy (dest, &four, 4);
+	dest += 4;
+	vx = _mm_add_epi32 (vx, vxstep);
+	vy = _mm_add_epi32 (vy, vystep);
+    }
+
+    xfrac = _mm_cvtsi128_si32 (vx);
+    yfrac = _mm_cvtsi128_si32 (vy);
+    for ( ; count ; count--)
+    {
+	*dest++ = colormap[source[((yfrac>>(16-6))&(63*64))
+				  + ((xfrac>>16)&63)]];
+	xfrac += ds_xstep;
+	yfrac += ds_ystep;
+    }
+}
+
+
+//
+// R_DrawColumnAVX2
+// Eight texels and their colormap entries
+//  with two gathers, stored down the column one by one.
+// Gathers read whole words, see I_ZoneBase.
+//
+__attribute__ ((target ("avx2")))
+void R_DrawColumnAVX2 (void)
+{
+    int			count;
+    byte*		dest;
+    byte*		source;
+    lighttable_t*	colormap;
+    unsigned		frac;
+    unsigned		fracstep;
+    __m256i		vfrac;
+    __m256i		vstep;
+    __m256i		mask;
+    __m256i		bytes;
+    __m256i		v;
+    unsigned		pix[8] __attribute__ ((aligned (32)));
+
+    count = dc_yh - dc_yl;
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+	I_Error ("R_DrawColumn: %i to %i at %i", dc_yl, dc_yh, dc_x);
+#endif
+
+    dest = ylookup[dc_yl] + columnofs[dc_x];
+    dccount += count+1;
+    count++;
+
+    source = dc_source;
+    colormap = dc_colormap;
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*dc_iscale;
+
+    vfrac = _mm256_add_epi32 (_mm256_set1_epi32 (frac),
+			      _mm256_mullo_epi32 (_mm256_set1_epi32 (fracstep),
+						  _mm256_setr_epi32 (0,1,2,3,4,5,6,7)));
+    vstep = _mm256_set1_epi32 (fracstep*8);
+    mask = _mm256_set1_epi32 (127);
+    bytes = _mm256_set1_epi32 (255);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+	v = _mm256_and_si256 (_mm256_srli_epi32 (vfrac, FRACBITS), mask);
+	v = _mm256_i32gather_epi32 ((int const *)source, v, 1);
+	v = _mm256_and_si256 (v, bytes);
+	v = _mm256_i32gather_epi32 ((int const *)colormap, v, 1);
+	_mm256_store_si256 ((__m256i *)pix, v);
+
+	dest[0] = pix[0];
+	dest[SCREENWIDTH] = pix[1];
+	dest[SCREENWIDTH*2] = pix[2];
+	dest[SCREENWIDTH*3] = pix[3];
+	dest[SCREENWIDTH*4] = pix[4];
+	dest[SCREENWIDTH*5] = pix[5];
+	dest[SCREENWIDTH*6] = pix[6];
+	dest[SCREENWIDTH*7] = pix[7];
+	dest += SCREENWIDTH*8;
+	vfrac = _mm256_add_epi32 (vfrac, vstep);
+    }
+
+    frac = _mm_cvtsi128_si32 (_mm256_castsi256_si128 (vfrac));
+    for ( ; count ; count--)
+    {
+	*dest = colormap[source[(frac>>FRACBITS)&127]];
+	dest += SCREENWIDTH;
+	frac += fracstep;
+    }
+}
+
+
+//
+// R_DrawTranslatedColumnAVX2
+// As above, with the translation gather in between.
+//
+__attribute__ ((target ("avx2")))
+void R_DrawTranslatedColumnAVX2 (void)
+{
+    int			count;
+    byte*		dest;
+    byte*		source;
+    byte*		translation;
+    lighttable_t*	colormap;
+    int			frac;
+    int			fracstep;
+    __m256i		vfrac;
+    __m256i		vstep;
+    __m256i		bytes;
+    __m256i		v;
+    unsigned		pix[8] __attribute__ ((aligned (32)));
+
+    count = dc_yh - dc_yl;
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+    {
+	I_Error ( "R_DrawColumn: %i to %i at %i",
+		  dc_yl, dc_yh, dc_x);
+    }
+#endif
+
+    dest = ylookup[dc_yl] + columnofs[dc_x];
+    dccount += count+1;
+    count++;
+
+    source = dc_source;
+    translation = dc_translation;
+    colormap = dc_colormap;
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    vfrac = _mm256_add_epi32 (_mm256_set1_epi32 (frac),
+			      _mm256_mullo_epi32 (_mm256_set1_epi32 (fracstep),
+						  _mm256_setr_epi32 (0,1,2,3,4,5,6,7)));
+    vstep = _mm256_set1_epi32 (fracstep*8);
+    bytes = _mm256_set1_epi32 (255);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+	// no wrap here, sprites are drawn a post at a time
+	v = _mm256_srai_epi32 (vfrac, FRACBITS);
+	v = _mm256_i32gather_epi32 ((int const *)source, v, 1);
+	v = _mm256_and_si256 (v, bytes);
+	v = _mm256_i32gather_epi32 ((int const *)translation, v, 1);
+	v = _mm256_and_si256 (v, bytes);
+	v = _mm256_i32gather_epi32 ((int const *)colormap, v, 1);
+	_mm256_store_si256 ((__m256i *)pix, v);
+
+	dest[0] = pix[0];
+	dest[SCREENWIDTH] = pix[1];
+	dest[SCREENWIDTH*2] = pix[2];
+	dest[SCREENWIDTH*3] = pix[3];
+	dest[SCREENWIDTH*4] = pix[4];
+	dest[SCREENWIDTH*5] = pix[5];
+	dest[SCREENWIDTH*6] = pix[6];
+	dest[SCREENWIDTH*7] = pix[7];
+	dest += SCREENWIDTH*8;
+	vfrac = _mm256_add_epi32 (vfrac, vstep);
+    }
+
+    frac = _mm_cvtsi128_si32 (_mm256_castsi256_si128 (vfrac));
+    for ( ; count ; count--)
+    {
+	*dest = colormap[translation[source[frac>>FRACBITS]]];
+	dest += SCREENWIDTH;
+	frac += fracstep;
+    }
+}
+
+
+//
+// R_DrawTranslatedColumnSSE2
+// R_DrawColumnSSE2 with the translation lookup.
+//
+__attribute__ ((target ("sse2")))
+void R_DrawTranslatedColumnSSE2 (void)
+{
+    int			count;
+    byte*		dest;
+    byte*		source;
+    byte*		translation;
+    lighttable_t*	colormap;
+    int			frac;
+    int			fracstep;
+    __m128i		vfrac;
+    __m128i		vstep;
+    int			idx[4] __attribute__ ((aligned (16)));
+
+    count = dc_yh - dc_yl;
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+    {
+	I_Error ( "R_DrawColumn: %i to %i at %i",
+		  dc_yl, dc_yh, dc_x);
+    }
+#endif
+
+    dest = ylookup[dc_yl] + columnofs[dc_x];
+    dccount += count+1;
+    count++;
+
+    source = dc_source;
+    translation = dc_translation;
+    colormap = dc_colormap;
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    vfrac = _mm_set_epi32 (frac+fracstep*3, frac+fracstep*2,
+			   frac+fracstep, frac);
+    vstep = _mm_set1_epi32 (fracstep*4);
+
+    for ( ; count >= 4 ; count -= 4)
+    {
+	// no wrap here, sprites are drawn a post at a time
+	_mm_store_si128 ((__m128i *)idx, _mm_srai_epi32 (vfrac, FRACBITS));
+	dest[0] = colormap[translation[source[idx[0]]]];
+	dest[SCREENWIDTH] = colormap[translation[source[idx[1]]]];
+	dest[SCREENWIDTH*2] = colormap[translation[source[idx[2]]]];
+	dest[SCREENWIDTH*3] = colormap[translation[source[idx[3]]]];
+	dest += SCREENWIDTH*4;
+	vfrac = _mm_add_epi32 (vfrac, vstep);
+    }
+
+    frac = _mm_cvtsi128_si32 (vfrac);
+    for ( ; count ; count--)
+    {
+	*dest = colormap[translation[source[frac>>FRACBITS]]];
+	dest += SCREENWIDTH;
+	frac += fracstep;
+    }
+}
+
+
+//
+// R_DrawFuzzColumnSSE2
+// Four neighbour offsets at a time out of fuzzrun,
+//  so fuzzpos only wraps once per four pixels.
+// The pixels are still done top down, one fuzzing
+//  from the one above reads it already fuzzed,
+//  and pixels and fuzzpos come out as R_DrawFuzzColumn's.
+//
+__attribute__ ((target ("sse2")))
+void R_DrawFuzzColumnSSE2 (void)
+{
+    int			count;
+    byte*		dest;
+    lighttable_t*	colormap;
+    __m128i		rows;
+    int			ofs[4] __attribute__ ((aligned (16)));
+
+    // Adjust borders. Low... 
+    if (!dc_yl) 
+	dc_yl = 1;
+
+    // .. and high.
+    if (dc_yh == viewheight-1) 
+	dc_yh = viewheight - 2; 
+		 
+    count = dc_yh - dc_yl; 
+    if (count < 0) 
+	return; 
+
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0 || dc_yh >= SCREENHEIGHT)
+    {
+	I_Error ("R_DrawFuzzColumn: %i to %i at %i",
+		 dc_yl, dc_yh, dc_x);
+    }
+#endif
+
+    dest = ylookup[dc_yl] + columnofs[dc_x];
+    dccount += count+1;
+    count++;
+
+    colormap = colormaps + 6*256;
+    rows = _mm_setr_epi32 (0, SCREENWIDTH, SCREENWIDTH*2, SCREENWIDTH*3);
+
+    for ( ; count >= 4 ; count -= 4)
+    {
+	_mm_store_si128 ((__m128i *)ofs,
+			 _mm_add_epi32 (rows, _mm_loadu_si128
+					((__m128i *)&fuzzrun[fuzzpos])));
+	dest[0] = colormap[dest[ofs[0]]];
+	dest[SCREENWIDTH] = colormap[dest[ofs[1]]];
+	dest[SCREENWIDTH*2] = colormap[dest[ofs[2]]];
+	dest[SCREENWIDTH*3] = colormap[dest[ofs[3]]];
+	dest += SCREENWIDTH*4;
+
+	fuzzpos += 4;
+	if (fuzzpos >= FUZZTABLE)
+	    fuzzpos -= FUZZTABLE;
+    }
+
+    for ( ; count ; count--)
+    {
+	*dest = colormap[dest[fuzzoffset[fuzzpos]]]; 
+	if (++fuzzpos == FUZZTABLE) 
+	    fuzzpos = 0;
+	dest += SCREENWIDTH;
+    }
+}
+
+
+//
+// R_DrawSpanAVX2
+// Eight spots, two gathers, packed down
+//  to two words per row of eight.
+//
+__attribute__ ((target ("avx2")))
+void R_DrawSpanAVX2 (void)
+{
+    int			count;
+    byte*		dest;
+    byte*		source;
+    lighttable_t*	colormap;
+    unsigned		xfrac;
+    unsigned		yfrac;
+    unsigned		four;
+    __m256i		vx;
+    __m256i		vy;
+    __m256i		vxstep;
+    __m256i		vystep;
+    __m256i		xmask;
+    __m256i		ymask;
+    __m256i		bytes;
+    __m256i		lane;
+    __m256i		v;
+
+#ifdef RANGECHECK
+    if (ds_x2 < ds_x1
+	|| ds_x1<0
+	|| ds_x2>=SCREENWIDTH
+	|| (unsigned)ds_y>SCREENHEIGHT)
+    {
+	I_Error( "R_DrawSpan: %i to %i at %i",
+		 ds_x1,ds_x2,ds_y);
+    }
+#endif
+
+    dest = ylookup[ds_y] + columnofs[ds_x1];
+    count = ds_x2 - ds_x1 + 1;
+    dscount += count;
+
+    source = ds_source;
+    colormap = ds_colormap;
+    xfrac = ds_xfrac;
+    yfrac = ds_yfrac;
+
+    lane = _mm256_setr_epi32 (0,1,2,3,4,5,6,7);
+    vx = _mm256_add_epi32 (_mm256_set1_epi32 (xfrac),
+			   _mm256_mullo_epi32 (_mm256_set1_epi32 (ds_xstep), lane));
+    vy = _mm256_add_epi32 (_mm256_set1_epi32 (yfrac),
+			   _mm256_mullo_epi32 (_mm256_set1_epi32 (ds_ystep), lane));
+    vxstep = _mm256_set1_epi32 (ds_xstep*8);
+    vystep = _mm256_set1_epi32 (ds_ystep*8);
+    xmask = _mm256_set1_epi32 (63);
+    ymask = _mm256_set1_epi32 (63*64);
+    bytes = _mm256_set1_epi32 (255);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+	v = _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi32 (vy, 16-6),
+					       ymask),
+			     _mm256_and_si256 (_mm256_srli_epi32 (vx, 16),
+					       xmask));
+	v = _mm256_i32gather_epi32 ((int const *)source, v, 1);
+	v = _mm256_and_si256 (v, bytes);
+	v = _mm256_i32gather_epi32 ((int const *)colormap, v, 1);
+	v = _mm256_and_si256 (v, bytes);
+
+	// packs stay inside each half,
+	//  leaving pixels 0-3 low and 4-7 high
+	v = _mm256_packus_epi32 (v, v);
+	v = _mm256_packus_epi16 (v, v);
+	four = _mm_cvtsi128_si32 (_mm256_castsi256_si128 (v));
+	memcpy (dest, &four, 4);
+	four = _mm_cvtsi128_si32 (_mm256_extracti128_si256 (v, 1));
+	memcpy (dest+4, &four, 4);
+	dest += 8;
+
+	vx = _mm256_add_epi32 (vx, vxstep);
+	vy = _mm256_add_epi32 (vy, vystep);
+    }
+
+    xfrac = _mm_cvtsi128_si32 (_mm256_castsi256_si128 (vx));
+    yfrac = _mm_cvtsi128_si32 (_mm256_castsi256_si128 (vy));
+    for ( ; count ; count--)
+    {
+	*dest++ = colormap[source[((yfrac>>(16-6))&(63*64))
+				  + ((xfrac>>16)&63)]];
+	xfrac += ds_xstep;
+	yfrac += ds_ystep;
+    }
+}
+#endif
+
+
+//
+// R_SetDrawers
+//
+void R_SetDrawers (int detail)
+{
+    R_InitFuzzRun ();
+
+    colfunc = basecolfunc = R_DrawColumn;
+    fuzzcolfunc = R_DrawFuzzColumn;
+    transcolfunc = R_DrawTranslatedColumn;
+    skycolfunc = R_DrawSkyColumn;
+    litcolfunc = R_DrawLitColumn;
+    mipcolfunc = R_DrawColumnMip;
+    spanfunc = R_DrawSpan;
+    mipspanfunc = R_DrawSpanMip;
+
+#ifdef CPU_X86
+    if (cputier >= cpu_sse2)
+    {
+	colfunc = basecolfunc = R_DrawColumnSSE2;
+	transcolfunc = R_DrawTranslatedColumnSSE2;
+	fuzzcolfunc = R_DrawFuzzColumnSSE2;
+	spanfunc = R_DrawSpanSSE2;
+    }
+    if (cputier >= cpu_avx2)
+    {
+	// the translated one stays SSE2, its two gathers
+	//  lose to four plain lookups, see -benchdrawers
+	colfunc = basecolfunc = R_DrawColumnAVX2;
+	spanfunc = R_DrawSpanAVX2;
+    }
+#endif
+
+    // blocky mode is plain C only
+    if (detail)
+    {
+	colfunc = basecolfunc = R_DrawColumnLow;
+	skycolfunc = R_DrawSkyColumnLow;
+	litcolfunc = R_DrawLitColumnLow;
+	mipcolfunc = R_DrawColumnMipLow;
+	spanfunc = R_DrawSpanLow;
+	mipspanfunc = R_DrawSpanMipLow;
+    }
+}
+
+//
+// R_InitBuffer 
+// Creats lookup tables that avoid
+//  multiplies and other hazzles
+//  for getting the framebuffer address
+//  of a pixel to draw.
+//
+void
+R_InitBuffer
+( int		width,
+  int		height ) 
+{ 
+    int		i; 
+
+    // Handle resize,
+    //  e.g. smaller view windows
+    //  with border and/or status bar.
+    viewwindowx = (SCREENWIDTH-width) >> 1; 
+
+    // Column offset. For windows.
+    for (i=0 ; i<width ; i++) 
+	columnofs[i] = viewwindowx + i;
+
+    // Samw with base row offset.
+    if (width == SCREENWIDTH) 
+	viewwindowy = 0; 
+    else 
+	viewwindowy = (SCREENHEIGHT-SBARHEIGHT-height) >> 1; 
+
+    // Preclaculate all row offsets.
+    for (i=0 ; i<height ; i++) 
+	ylookup[i] = screens[0] + (i+viewwindowy)*SCREENWIDTH; 
+} 
+
+
+//
+// R_InitScaleBuffer
+// Points the drawers at scalebuffer
+//  and sets up the stretch into the window.
+//
+void R_InitScaleBuffer (void)
+{
+    int		i;
+    int		width;
+    fixed_t	frac;
+    fixed_t	step;
+
+    if (!scalebuffer)
+	scalebuffer = Z_Malloc (SCREENWIDTH*SCREENHEIGHT, PU_STATIC, NULL);
+
+    width = viewwidth<<detailshift;
+    for (i=0 ; i<width ; i++)
+	columnofs[i] = i;
+    for (i=0 ; i<viewheight ; i++)
+	ylookup[i] = scalebuffer + i*SCREENWIDTH;
+
+    // nearest pixel, sampled at the centres
+    step = (width<<FRACBITS)/scaledviewwidth;
+    for (i=0, frac=step/2 ; i<scaledviewwidth ; i++, frac+=step)
+	scalecolumns[i] = frac>>FRACBITS;
+
+    step = (viewheight<<FRACBITS)/scaledviewheight;
+    for (i=0, frac=step/2 ; i<scaledviewheight ; i++, frac+=step)
+	scalerows[i] = frac>>FRACBITS;
+}
+
+
+//
+// R_ScaleView
+// Stretches scalebuffer into the view window.
+//
+void R_ScaleView (void)
+{
+    int		x;
+    int		y;
+    byte*	src;
+    byte*	dest;
+
+    dest = screens[0] + viewwindowy*SCREENWIDTH + viewwindowx;
+    for (y=0 ; y<scaledviewheight ; y++, dest+=SCREENWIDTH)
+    {
+	// repeated rows are copies of the one above
+	if (y && scalerows[y] == scalerows[y-1])
+	{
+	    memcpy (dest, dest-SCREENWIDTH, scaledviewwidth);
+	    continue;
+	}
+
+	src = scalebuffer + scalerows[y]*SCREENWIDTH;
+	for (x=0 ; x<scaledviewwidth ; x++)
+	    dest[x] = src[scalecolumns[x]];
+    }
+}
+ 
+ 
+
+
+//
+// R_FillBackScreen
+// Fills the back screen with a pattern
+//  for variable screen sizes
+// Also draws a beveled edge.
+//
+void R_FillBackScreen (void) 
+{ 
+    byte*	src;
+    byte*	dest; 
+    int		x;
     int		y; 
     patch_t*	patch;
 
@@ -777,14 +1781,14 @@ void R_FillBackScreen (void)
     patch = W_CacheLumpName ("brdr_b",PU_CACHE);
 
     for (x=0 ; x<scaledviewwidth ; x+=8)
-	V_DrawPatch (viewwindowx+x,viewwindowy+viewheight,1,patch);
+	V_DrawPatch (viewwindowx+x,viewwindowy+scaledviewheight,1,patch);
     patch = W_CacheLumpName ("brdr_l",PU_CACHE);
 
-    for (y=0 ; y<viewheight ; y+=8)
+    for (y=0 ; y<scaledviewheight ; y+=8)
 	V_DrawPatch (viewwindowx-8,viewwindowy+y,1,patch);
     patch = W_CacheLumpName ("brdr_r",PU_CACHE);
 
-    for (y=0 ; y<viewheight ; y+=8)
+    for (y=0 ; y<scaledviewheight ; y+=8)
 	V_DrawPatch (viewwindowx+scaledviewwidth,viewwindowy+y,1,patch);
 
 
@@ -800,12 +1804,12 @@ void R_FillBackScreen (void)
 		 W_CacheLumpName ("brdr_tr",PU_CACHE));
     
     V_DrawPatch (viewwindowx-8,
-		 viewwindowy+viewheight,
+		 viewwindowy+scaledviewheight,
 		 1,
 		 W_CacheLumpName ("brdr_bl",PU_CACHE));
     
     V_DrawPatch (viewwindowx+scaledviewwidth,
-		 viewwindowy+viewheight,
+		 viewwindowy+scaledviewheight,
 		 1,
 		 W_CacheLumpName ("brdr_br",PU_CACHE));
 } 
@@ -825,6 +1829,10 @@ R_VideoErase
   //  a 32bit CPU, as GNU GCC/Linux libc did
   //  at one point.
     memcpy (screens[0]+ofs, screens[1]+ofs, count); 
+
+    if (count > 0)
+	V_MarkRect (0, ofs/SCREENWIDTH, SCREENWIDTH,
+		    (ofs+count-1)/SCREENWIDTH - ofs/SCREENWIDTH + 1);
 } 
 
 
@@ -850,21 +1858,21 @@ void R_DrawViewBorder (void)
     if (scaledviewwidth == SCREENWIDTH) 
 	return; 
   
-    top = ((SCREENHEIGHT-SBARHEIGHT)-viewheight)/2; 
+    top = ((SCREENHEIGHT-SBARHEIGHT)-scaledviewheight)/2; 
     side = (SCREENWIDTH-scaledviewwidth)/2; 
  
     // copy top and one line of left side 
     R_VideoErase (0, top*SCREENWIDTH+side); 
  
     // copy one line of right side and bottom 
-    ofs = (viewheight+top)*SCREENWIDTH-side; 
+    ofs = (scaledviewheight+top)*SCREENWIDTH-side; 
     R_VideoErase (ofs, top*SCREENWIDTH+side); 
  
     // copy sides using wraparound 
     ofs = top*SCREENWIDTH + SCREENWIDTH-side; 
     side <<= 1;
     
-    for (i=1 ; i<viewheight ; i++) 
+    for (i=1 ; i<scaledviewheight ; i++) 
     { 
 	R_VideoErase (ofs, side); 
 	ofs += SCREENWIDTH; 
@@ -875,3 +1883,157 @@ void R_DrawViewBorder (void)
 } 
  
  
+
+
+
+//
+// Drawer benchmarks, for -benchdrawers.
+// Each processor drawer is checked against the C one
+//  for the same pixels (and fuzzpos), then both are timed.
+//
+#define BENCHCOLUMNS	(SCREENWIDTH*400)
+#define CHECKCOLUMNS	(SCREENWIDTH*3)
+
+typedef struct
+{
+    char*	name;
+    cputier_t	tier;
+    void	(*scalar) (void);
+    void	(*fast) (void);
+
+} drawerbench_t;
+
+static drawerbench_t	drawerbenches[] =
+{
+#ifdef CPU_X86
+    { "column", cpu_sse2, R_DrawColumn, R_DrawColumnSSE2 },
+    { "column", cpu_avx2, R_DrawColumn, R_DrawColumnAVX2 },
+    { "translated", cpu_sse2, R_DrawTranslatedColumn, R_DrawTranslatedColumnSSE2 },
+    { "translated", cpu_avx2, R_DrawTranslatedColumn, R_DrawTranslatedColumnAVX2 },
+    { "fuzz", cpu_sse2, R_DrawFuzzColumn, R_DrawFuzzColumnSSE2 },
+#endif
+    { NULL }
+};
+
+static byte		benchsource[256];
+
+
+//
+// R_BenchColumns
+// Draws columns across buffer, of lengths
+//  that leave every tail size.
+//
+static void
+R_BenchColumns
+( void		(*drawer) (void),
+  int		columns )
+{
+    int		i;
+
+    for (i=0 ; i<columns ; i++)
+    {
+	dc_x = i % SCREENWIDTH;
+	dc_yl = i % 13;
+	dc_yh = SCREENHEIGHT-1 - i%7;
+	dc_source = benchsource;
+	dc_colormap = colormaps + (i&15)*256;
+	dc_translation = translationtables + (i%3)*256;
+	dc_iscale = FRACUNIT*3/4;
+	dc_texturemid = centery*dc_iscale;
+	drawer ();
+    }
+}
+
+
+//
+// R_BenchDrawers
+//
+void R_BenchDrawers (void)
+{
+    drawerbench_t*	bench;
+    byte*		saverows[SCREENHEIGHT];
+    int			savecolumns[SCREENWIDTH];
+    int			saveheight;
+    int			savecentery;
+    int			savefuzzpos;
+    byte*		scalarbuf;
+    byte*		fastbuf;
+    int			scalarpos;
+    unsigned		start;
+    unsigned		scalartime;
+    unsigned		fasttime;
+    int			i;
+
+    if (!M_CheckParm ("-benchdrawers"))
+	return;
+
+    memcpy (saverows, ylookup, sizeof(saverows));
+    memcpy (savecolumns, columnofs, sizeof(savecolumns));
+    saveheight = viewheight;
+    savecentery = centery;
+    savefuzzpos = fuzzpos;
+
+    // before the first R_SetDrawers
+    R_InitFuzzRun ();
+
+    viewheight = SCREENHEIGHT;
+    centery = SCREENHEIGHT/2;
+    for (i=0 ; i<SCREENWIDTH ; i++)
+	columnofs[i] = i;
+    for (i=0 ; i<256 ; i++)
+	benchsource[i] = i*97 + (i>>3);
+
+    scalarbuf = Z_Malloc (SCREENWIDTH*SCREENHEIGHT, PU_STATIC, 0);
+    fastbuf = Z_Malloc (SCREENWIDTH*SCREENHEIGHT, PU_STATIC, 0);
+
+    printf ("\nR_BenchDrawers: %i columns each\n", BENCHCOLUMNS);
+    for (bench = drawerbenches ; bench->name ; bench++)
+    {
+	if (cputier < bench->tier)
+	    continue;
+
+	// same pixels, and the same fuzzpos after
+	for (i=0 ; i<SCREENWIDTH*SCREENHEIGHT ; i++)
+	    scalarbuf[i] = fastbuf[i] = i*31 + (i>>9);
+
+	for (i=0 ; i<SCREENHEIGHT ; i++)
+	    ylookup[i] = scalarbuf + i*SCREENWIDTH;
+	fuzzpos = 0;
+	R_BenchColumns (bench->scalar, CHECKCOLUMNS);
+	scalarpos = fuzzpos;
+
+	for (i=0 ; i<SCREENHEIGHT ; i++)
+	    ylookup[i] = fastbuf + i*SCREENWIDTH;
+	fuzzpos = 0;
+	R_BenchColumns (bench->fast, CHECKCOLUMNS);
+
+	if (memcmp (scalarbuf, fastbuf, SCREENWIDTH*SCREENHEIGHT)
+	    || fuzzpos != scalarpos)
+	    printf ("  %s %s: DIFFERS from C\n",
+		    bench->name, cputiernames[bench->tier]);
+
+	start = I_GetTimeUS ();
+	R_BenchColumns (bench->fast, BENCHCOLUMNS);
+	fasttime = I_GetTimeUS () - start;
+
+	for (i=0 ; i<SCREENHEIGHT ; i++)
+	    ylookup[i] = scalarbuf + i*SCREENWIDTH;
+	start = I_GetTimeUS ();
+	R_BenchColumns (bench->scalar, BENCHCOLUMNS);
+	scalartime = I_GetTimeUS () - start;
+
+	printf ("  %-10s %-6s %7u us, C %7u us\n",
+		bench->name, cputiernames[bench->tier],
+		fasttime, scalartime);
+    }
+
+    Z_Free (scalarbuf);
+    Z_Free (fastbuf);
+
+    memcpy (ylookup, saverows, sizeof(saverows));
+    memcpy (columnofs, savecolumns, sizeof(savecolumns));
+    viewheight = saveheight;
+    centery = savecentery;
+    fuzzpos = savefuzzpos;
+    dccount = 0;
+}
@@ -29,15 +29,24 @@
 #endif
 
 
-extern lighttable_t*	dc_colormap;
-extern int		dc_x;
-extern int		dc_yl;
-extern int		dc_yh;
-extern fixed_t		dc_iscale;
-extern fixed_t		dc_texturemid;
+extern VIEWSTATE lighttable_t*	dc_colormap;
+extern VIEWSTATE int		dc_x;
+extern VIEWSTATE int		dc_yl;
+extern VIEWSTATE int		dc_yh;
+extern VIEWSTATE fixed_t		dc_iscale;
+extern VIEWSTATE fixed_t		dc_texturemid;
 
 // first pixel in a column
-extern byte*		dc_source;		
+extern VIEWSTATE byte*		dc_source;		
+extern VIEWSTATE int		dc_mip;
+
+// framebuffer address of each view row and column
+extern VIEWSTATE byte*		ylookup[];
+extern VIEWSTATE int		columnofs[];
+
+// pixels drawn this frame, for profiling
+extern VIEWSTATE int		dccount;
+extern VIEWSTATE int		dscount;
 
 
 // The span blitting interface.
@@ -56,27 +65,45 @@ void 	R_DrawFuzzColumnLow (void);
 void	R_DrawTranslatedColumn (void);
 void	R_DrawTranslatedColumnLow (void);
 
+// The sky, dc_source is already scaled and lit
+//  and is indexed by view row.
+void	R_DrawSkyColumn (void);
+void	R_DrawSkyColumnLow (void);
+
+// Walls out of the lit cache, dc_source is
+//  already through dc_colormap.
+void	R_DrawLitColumn (void);
+void	R_DrawLitColumnLow (void);
+
+// Mip levels, dc_source is (128>>dc_mip) tall,
+//  ds_source (64>>ds_mip) square.
+void	R_DrawColumnMip (void);
+void	R_DrawColumnMipLow (void);
+void	R_DrawSpanMip (void);
+void	R_DrawSpanMipLow (void);
+
 void
 R_VideoErase
 ( unsigned	ofs,
   int		count );
 
-extern int		ds_y;
-extern int		ds_x1;
-extern int		ds_x2;
+extern VIEWSTATE int		ds_y;
+extern VIEWSTATE int		ds_x1;
+extern VIEWSTATE int		ds_x2;
 
-extern lighttable_t*	ds_colormap;
+extern VIEWSTATE lighttable_t*	ds_colormap;
 
-extern fixed_t		ds_xfrac;
-extern fixed_t		ds_yfrac;
-extern fixed_t		ds_xstep;
-extern fixed_t		ds_ystep;
+extern VIEWSTATE fixed_t		ds_xfrac;
+extern VIEWSTATE fixed_t		ds_yfrac;
+extern VIEWSTATE fixed_t		ds_xstep;
+extern VIEWSTATE fixed_t		ds_ystep;
 
 // start of a 64*64 tile image
-extern byte*		ds_source;		
+extern VIEWSTATE byte*		ds_source;		
+extern VIEWSTATE int		ds_mip;
 
 extern byte*		translationtables;
-extern byte*		dc_translation;
+extern VIEWSTATE byte*		dc_translation;
 
 
 // Span blitting for rows, floor/ceiling.
@@ -86,12 +113,39 @@ void 	R_DrawSpan (void);
 // Low resolution mode, 160x200?
 void 	R_DrawSpanLow (void);
 
+// Same pixels as the plain C drawers,
+//  several at a time.
+void	R_DrawColumnSSE2 (void);
+void	R_DrawSpanSSE2 (void);
+void	R_DrawColumnAVX2 (void);
+void	R_DrawTranslatedColumnAVX2 (void);
+void	R_DrawTranslatedColumnSSE2 (void);
+void	R_DrawFuzzColumnSSE2 (void);
+void	R_DrawSpanAVX2 (void);
+
+// Called by R_ExecuteSetViewSize,
+//  binds colfunc, spanfunc etc. for the detail level
+//  and the drawers the processor can run.
+void	R_SetDrawers (int detail);
+
 
 void
 R_InitBuffer
 ( int		width,
   int		height );
 
+// Called by R_ExecuteSetViewSize when viewscale
+//  is below VIEWSCALEMAX.
+void	R_InitScaleBuffer (void);
+
+// Called by R_RenderPlayerView after the view
+//  has been drawn into the scale buffer.
+void	R_ScaleView (void);
+
+// Called by R_Init, for -benchdrawers times the
+//  processor drawers against the C ones.
+void	R_BenchDrawers (void);
+
 
 // Initialize color translation tables,
 //  for player rendering etc.
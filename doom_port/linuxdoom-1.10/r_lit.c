@@ -0,0 +1,275 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Lit texture cache.
+//	Wall columns are drawn through dc_colormap, two dependent
+//	 loads a pixel. For each texture and colormap pair the
+//	 displayed view draws the most, the whole texture is kept
+//	 with the colormap applied, so the drawer just copies.
+//	Only the first 128 rows are kept, as many as the column
+//	 drawers wrap at, so the pixels come out the same.
+//	The cache is malloced, outside the zone, so it can't
+//	 crowd out the level or fragment the zone as the set
+//	 of hot textures changes.
+//
+//-----------------------------------------------------------------------------
+
+static const char
+rcsid[] = "$Id:$";
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomdef.h"
+
+#include "i_system.h"
+#include "m_argv.h"
+#include "m_prof.h"
+
+#include "r_local.h"
+
+#ifdef __GNUG__
+#pragma implementation "r_lit.h"
+#endif
+#include "r_lit.h"
+
+
+extern int		numtextures;
+
+
+// The light levels, invulnerability and all black.
+#define LITMAPS			(NUMCOLORMAPS+2)
+
+// Rows kept of each column.
+#define LITHEIGHT		128
+
+// Default budget, in kilobytes.
+#define LITBUDGET		2048
+
+// Textures built a frame, so a new area
+//  doesn't stall a single frame.
+#define LITBUILDS		8
+
+
+boolean			litcache;
+static int		litbudget;
+
+// numtextures*LITMAPS of each
+static byte**		litcolumns;
+static int*		litcounts;	// columns drawn this frame
+
+static int		litmemory;
+static int		lithits;
+static int		litmisses;
+
+typedef struct
+{
+    int		index;
+    int		count;
+} litpair_t;
+
+static litpair_t*	litpairs;
+
+
+
+//
+// R_InitLitCache
+//
+void R_InitLitCache (void)
+{
+    int		p;
+
+    p = M_CheckParm ("-litcache");
+    if (!p)
+	return;
+
+    litcache = true;
+    litbudget = LITBUDGET;
+    if (p < myargc-1 && atoi (myargv[p+1]) > 0)
+	litbudget = atoi (myargv[p+1]);
+    litbudget *= 1024;
+
+    litcolumns = calloc (numtextures*LITMAPS, sizeof(*litcolumns));
+    litcounts = calloc (numtextures*LITMAPS, sizeof(*litcounts));
+    litpairs = calloc (numtextures*LITMAPS, sizeof(*litpairs));
+    if (!litcolumns || !litcounts || !litpairs)
+	I_Error ("R_InitLitCache: couldn't allocate the cache tables");
+}
+
+
+
+//
+// R_GetLitColumn
+// Only the displayed view counts, it is on one thread.
+//
+byte*
+R_GetLitColumn
+( int		tex,
+  int		col,
+  lighttable_t*	colormap )
+{
+    byte*	lit;
+    int		i;
+
+    i = tex*LITMAPS + ((colormap - colormaps)>>8);
+    lit = litcolumns[i];
+
+    if (mainview)
+    {
+	litcounts[i]++;
+	if (lit)
+	    lithits++;
+	else
+	    litmisses++;
+    }
+
+    if (!lit)
+	return NULL;
+    return lit + (col & texturewidthmask[tex])*LITHEIGHT;
+}
+
+
+
+//
+// R_BuildLit
+// Just stays uncached if there is no memory for it.
+//
+static void R_BuildLit (int i)
+{
+    byte*	source;
+    byte*	dest;
+    byte*	colormap;
+    int		tex;
+    int		width;
+    int		col;
+    int		y;
+
+    tex = i / LITMAPS;
+    colormap = colormaps + (i % LITMAPS)*256;
+    width = texturewidthmask[tex]+1;
+
+    dest = malloc (width*LITHEIGHT);
+    if (!dest)
+	return;
+    litcolumns[i] = dest;
+    litmemory += width*LITHEIGHT;
+
+    for (col=0 ; col<width ; col++)
+    {
+	source = R_GetColumn (tex, col);
+	for (y=0 ; y<LITHEIGHT ; y++)
+	    *dest++ = colormap[source[y]];
+    }
+}
+
+
+//
+// R_FreeLit
+//
+static void R_FreeLit (int i)
+{
+    free (litcolumns[i]);
+    litcolumns[i] = NULL;
+    litmemory -= (texturewidthmask[i/LITMAPS]+1)*LITHEIGHT;
+}
+
+
+//
+// R_ComparePairs
+// Hottest first.
+//
+static int R_ComparePairs (const void* a, const void* b)
+{
+    return ((litpair_t *)b)->count - ((litpair_t *)a)->count;
+}
+
+
+//
+// R_UpdateLitCache
+//
+void R_UpdateLitCache (void)
+{
+    int		numpairs;
+    int		total;
+    int		size;
+    int		builds;
+    int		i;
+
+    if (!litcache)
+	return;
+
+    M_ProfCount (pc_lithits, lithits);
+    M_ProfCount (pc_litmisses, litmisses);
+    M_ProfCount (pc_litkb, litmemory/1024);
+    lithits = litmisses = 0;
+
+    // Textures shorter than the drawers wrap at
+    //  show whatever follows them, leave those alone.
+    // What is cached but wasn't drawn this frame
+    //  sorts last, it goes when the room is needed.
+    numpairs = 0;
+    for (i=0 ; i<numtextures*LITMAPS ; i++)
+    {
+	if ((litcounts[i] || litcolumns[i])
+	    && textureheight[i/LITMAPS] >= LITHEIGHT<<FRACBITS)
+	{
+	    litpairs[numpairs].index = i;
+	    litpairs[numpairs].count = litcounts[i];
+	    numpairs++;
+	}
+	litcounts[i] = -1;	// not wanted, unless marked below
+    }
+
+    qsort (litpairs, numpairs, sizeof(*litpairs), R_ComparePairs);
+
+    // the hottest that fit in the budget stay
+    total = 0;
+    for (i=0 ; i<numpairs ; i++)
+    {
+	size = (texturewidthmask[litpairs[i].index/LITMAPS]+1)*LITHEIGHT;
+	if (total + size > litbudget)
+	    continue;
+	total += size;
+	litcounts[litpairs[i].index] = 0;
+    }
+
+    // free the rest first, to make room
+    for (i=0 ; i<numtextures*LITMAPS ; i++)
+    {
+	if (litcounts[i])
+	{
+	    litcounts[i] = 0;
+	    if (litcolumns[i])
+		R_FreeLit (i);
+	}
+    }
+
+    builds = 0;
+    for (i=0 ; i<numpairs && builds<LITBUILDS ; i++)
+    {
+	if (litcolumns[litpairs[i].index])
+	    continue;
+	if (litmemory + (texturewidthmask[litpairs[i].index/LITMAPS]+1)
+	    *LITHEIGHT > litbudget)
+	    continue;
+	R_BuildLit (litpairs[i].index);
+	builds++;
+    }
+}
@@ -0,0 +1,59 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Wall textures with a colormap already applied,
+//	 for the textures and light levels drawn the most.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __R_LIT__
+#define __R_LIT__
+
+#include "r_defs.h"
+
+#ifdef __GNUG__
+#pragma interface
+#endif
+
+
+// Set by -litcache.
+extern boolean		litcache;
+
+
+// Called by R_Init.
+void R_InitLitCache (void);
+
+// The 128 texels of a wall column through colormap,
+//  or NULL if that texture and light aren't cached.
+byte*
+R_GetLitColumn
+( int		tex,
+  int		col,
+  lighttable_t*	colormap );
+
+// Called once a frame with no views being drawn,
+//  caches the hottest pairs of the frame.
+void R_UpdateLitCache (void);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
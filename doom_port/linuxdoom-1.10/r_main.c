@@ -36,9 +36,18 @@ static const char rcsid[] = "$Id: r_main.c,v 1.5 1997/02/03 22:45:12 b1 Exp $";
 #include "d_net.h"
 
 #include "m_bbox.h"
+#include "m_prof.h"
+#include "i_system.h"
 
 #include "r_local.h"
 #include "r_sky.h"
+#include "r_pvs.h"
+#include "r_view.h"
+#include "r_snap.h"
+#include "r_lit.h"
+#include "r_mip.h"
+
+#include "v_video.h"
 
 
 
@@ -55,8 +64,8 @@ int			viewangleoffset;
 int			validcount = 1;		
 
 
-lighttable_t*		fixedcolormap;
-extern lighttable_t**	walllights;
+VIEWSTATE lighttable_t*		fixedcolormap;
+extern VIEWSTATE lighttable_t**	walllights;
 
 int			centerx;
 int			centery;
@@ -66,26 +75,48 @@ fixed_t			centeryfrac;
 fixed_t			projection;
 
 // just for profiling purposes
-int			framecount;	
+VIEWSTATE int		framecount;	
+
+VIEWSTATE int			sscount;
+VIEWSTATE int			linecount;
+VIEWSTATE int			loopcount;
+
+VIEWSTATE fixed_t			viewx;
+VIEWSTATE fixed_t			viewy;
+VIEWSTATE fixed_t			viewz;
+
+VIEWSTATE angle_t			viewangle;
+
+VIEWSTATE fixed_t			viewcos;
+VIEWSTATE fixed_t			viewsin;
 
-int			sscount;
-int			linecount;
-int			loopcount;
+VIEWSTATE boolean			floatrender;
+boolean			floatcompare;
 
-fixed_t			viewx;
-fixed_t			viewy;
-fixed_t			viewz;
+VIEWSTATE float			viewxf;
+VIEWSTATE float			viewyf;
+VIEWSTATE float			viewcosf;
+VIEWSTATE float			viewsinf;
 
-angle_t			viewangle;
+#define ANGLETORADF	(3.14159265f/ANG180)
 
-fixed_t			viewcos;
-fixed_t			viewsin;
+VIEWSTATE player_t*		viewplayer;
 
-player_t*		viewplayer;
+VIEWSTATE sector_t*		viewsectors;
+VIEWSTATE side_t*		viewsides;
+VIEWSTATE int*			viewtexturetranslation;
+VIEWSTATE int*			viewflattranslation;
+
+// True while drawing the displayed view,
+//  only that one maps lines for the automap.
+VIEWSTATE boolean		mainview;
 
 // 0 = high, 1 = low
 int			detailshift;	
 
+int			viewscale = VIEWSCALEMAX;
+int			renderbudget;
+
 //
 // precalculated math tables
 //
@@ -114,19 +145,28 @@ fixed_t*		finecosine = &finesine[FINEANGLES/4];
 
 
 lighttable_t*		scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
-lighttable_t*		scalelightfixed[MAXLIGHTSCALE];
+VIEWSTATE lighttable_t*		scalelightfixed[MAXLIGHTSCALE];
 lighttable_t*		zlight[LIGHTLEVELS][MAXLIGHTZ];
 
 // bumped light from gun blasts
-int			extralight;			
+VIEWSTATE int			extralight;			
+
+// fraction of the way from the last tic to the current one,
+//  FRACUNIT draws things exactly where the playsim has them
+fixed_t			fractionaltic = FRACUNIT;
 
 
 
-void (*colfunc) (void);
+// switched per sprite, so per view
+VIEWSTATE void (*colfunc) (void);
 void (*basecolfunc) (void);
 void (*fuzzcolfunc) (void);
 void (*transcolfunc) (void);
+void (*skycolfunc) (void);
+void (*litcolfunc) (void);
+void (*mipcolfunc) (void);
 void (*spanfunc) (void);
+void (*mipspanfunc) (void);
 
 
 
@@ -682,16 +722,18 @@ void R_ExecuteSetViewSize (void)
     if (setblocks == 11)
     {
 	scaledviewwidth = SCREENWIDTH;
-	viewheight = SCREENHEIGHT;
+	scaledviewheight = SCREENHEIGHT;
     }
     else
     {
 	scaledviewwidth = setblocks*32;
-	viewheight = (setblocks*168/10)&~7;
+	scaledviewheight = (setblocks*168/10)&~7;
     }
     
+    // the view itself can be smaller than its window
     detailshift = setdetail;
-    viewwidth = scaledviewwidth>>detailshift;
+    viewwidth = ((scaledviewwidth*viewscale/VIEWSCALEMAX)&~1)>>detailshift;
+    viewheight = scaledviewheight*viewscale/VIEWSCALEMAX;
 	
     centery = viewheight/2;
     centerx = viewwidth/2;
@@ -699,22 +741,11 @@ void R_ExecuteSetViewSize (void)
     centeryfrac = centery<<FRACBITS;
     projection = centerxfrac;
 
-    if (!detailshift)
-    {
-	colfunc = basecolfunc = R_DrawColumn;
-	fuzzcolfunc = R_DrawFuzzColumn;
-	transcolfunc = R_DrawTranslatedColumn;
-	spanfunc = R_DrawSpan;
-    }
-    else
-    {
-	colfunc = basecolfunc = R_DrawColumnLow;
-	fuzzcolfunc = R_DrawFuzzColumn;
-	transcolfunc = R_DrawTranslatedColumn;
-	spanfunc = R_DrawSpanLow;
-    }
+    R_SetDrawers (detailshift);
 
-    R_InitBuffer (scaledviewwidth, viewheight);
+    R_InitBuffer (scaledviewwidth, scaledviewheight);
+    if (viewscale < VIEWSCALEMAX)
+	R_InitScaleBuffer ();
 	
     R_InitTextureMapping ();
     
@@ -732,6 +763,7 @@ void R_ExecuteSetViewSize (void)
 	dy = ((i-viewheight/2)<<FRACBITS)+FRACUNIT/2;
 	dy = abs(dy);
 	yslope[i] = FixedDiv ( (viewwidth<<detailshift)/2*FRACUNIT, dy);
+	yslopef[i] = (viewwidth<<detailshift)/2/fabsf (i-viewheight/2+0.5f);
     }
 	
     for (i=0 ; i<viewwidth ; i++)
@@ -789,6 +821,13 @@ void R_Init (void)
     printf ("\nR_InitSkyMap");
     R_InitTranslationTables ();
     printf ("\nR_InitTranslationsTables");
+    R_InitViews ();
+    printf ("\nR_InitViews");
+    R_InitLitCache ();
+    printf ("\nR_InitLitCache");
+    R_InitMips ();
+    printf ("\nR_InitMips");
+    R_BenchDrawers ();
 	
     framecount = 0;
 }
@@ -824,25 +863,81 @@ R_PointInSubsector
 
 
 
+//
+// R_InterpolateCoord
+// R_InterpolateAngle
+// Blend last tic's value toward the current one.
+// Never touches playsim state, so demos and netgames
+//  see exactly the same world as before.
+//
+fixed_t
+R_InterpolateCoord
+( fixed_t	oldval,
+  fixed_t	newval )
+{
+    if (fractionaltic >= FRACUNIT)
+	return newval;
+    return oldval + FixedMul (newval-oldval, fractionaltic);
+}
+
+
+angle_t
+R_InterpolateAngle
+( angle_t	oldval,
+  angle_t	newval )
+{
+    if (fractionaltic >= FRACUNIT)
+	return newval;
+    // the signed difference takes the short way around
+    return oldval + FixedMul ((int)(newval-oldval), fractionaltic);
+}
+
+
+
 //
 // R_SetupFrame
 //
 void R_SetupFrame (player_t* player)
 {		
     int		i;
+    mobj_t*	mo;
     
+    if (viewsnap)
+    {
+	viewsectors = viewsnap->sectors;
+	viewsides = viewsnap->sides;
+	viewtexturetranslation = viewsnap->texturetranslation;
+	viewflattranslation = viewsnap->flattranslation;
+    }
+    else
+    {
+	viewsectors = sectors;
+	viewsides = sides;
+	viewtexturetranslation = texturetranslation;
+	viewflattranslation = flattranslation;
+    }
+
     viewplayer = player;
-    viewx = player->mo->x;
-    viewy = player->mo->y;
-    viewangle = player->mo->angle + viewangleoffset;
+    mo = player->mo;
+    viewx = R_InterpolateCoord (mo->oldx, mo->x);
+    viewy = R_InterpolateCoord (mo->oldy, mo->y);
+    viewangle = R_InterpolateAngle (mo->oldangle, mo->angle) + viewangleoffset;
     extralight = player->extralight;
 
-    viewz = player->viewz;
+    viewz = R_InterpolateCoord (player->oldviewz, player->viewz);
     
     viewsin = finesine[viewangle>>ANGLETOFINESHIFT];
     viewcos = finecosine[viewangle>>ANGLETOFINESHIFT];
+
+    viewxf = (float)viewx/FRACUNIT;
+    viewyf = (float)viewy/FRACUNIT;
+    viewsinf = sinf (viewangle*ANGLETORADF);
+    viewcosf = cosf (viewangle*ANGLETORADF);
 	
     sscount = 0;
+    linecount = 0;
+    dccount = 0;
+    dscount = 0;
 	
     if (player->fixedcolormap)
     {
@@ -859,17 +954,60 @@ void R_SetupFrame (player_t* player)
 	fixedcolormap = 0;
 		
     framecount++;
-    validcount++;
 }
 
 
 
+//
+// R_GovernScale
+// Steps viewscale down as soon as the average render time
+//  goes over renderbudget, and back up only when the next scale
+//  should still fit with room to spare, for a second running.
+//
+#define SCALEHOLD	TICRATE
+
+void R_GovernScale (unsigned time)
+{
+    static unsigned	average;
+    static int		under;
+    unsigned		next;
+
+    average = average ? (average*7 + time)/8 : time;
+
+    if (average > renderbudget && viewscale > VIEWSCALEMIN)
+    {
+	viewscale--;
+	R_ExecuteSetViewSize ();
+	average = 0;
+	under = 0;
+	return;
+    }
+
+    // cost goes with the number of pixels
+    next = average*(viewscale+1)*(viewscale+1)/(viewscale*viewscale);
+    if (viewscale < VIEWSCALEMAX && next < renderbudget*7/8)
+    {
+	if (++under >= SCALEHOLD)
+	{
+	    viewscale++;
+	    R_ExecuteSetViewSize ();
+	    average = 0;
+	    under = 0;
+	}
+    }
+    else
+	under = 0;
+}
+
+
 //
 // R_RenderView
 //
-void R_RenderPlayerView (player_t* player)
+void R_RenderView (player_t* player)
 {	
+    mainview = true;
     R_SetupFrame (player);
+    R_SetupFramePVS ();
 
     // Clear buffers.
     R_ClearClipSegs ();
@@ -881,18 +1019,96 @@ void R_RenderPlayerView (player_t* player)
     NetUpdate ();
 
     // The head node is the last node output.
+    M_ProfBegin (prof_bsp);
     R_RenderBSPNode (numnodes-1);
+    M_ProfEnd (prof_bsp);
     
     // Check for new console commands.
     NetUpdate ();
     
+    M_ProfBegin (prof_planes);
     R_DrawPlanes ();
+    M_ProfEnd (prof_planes);
     
     // Check for new console commands.
     NetUpdate ();
     
+    M_ProfBegin (prof_masked);
     R_DrawMasked ();
+    M_ProfEnd (prof_masked);
+
+    if (viewscale < VIEWSCALEMAX)
+	R_ScaleView ();
+
+    M_ProfView ();
 
     // Check for new console commands.
     NetUpdate ();				
 }
+
+
+//
+// R_CompareFloat
+// Draws the view in fixed point and in float,
+//  and counts the pixels that came out different.
+//
+void R_CompareFloat (player_t* player)
+{
+    static byte	otherview[SCREENWIDTH*SCREENHEIGHT];
+    byte*	src;
+    byte*	dest;
+    boolean	wasfloat;
+    int		x;
+    int		y;
+    int		diffs;
+
+    // the caller's path goes last, it is the one shown
+    wasfloat = floatrender;
+    floatrender = !wasfloat;
+    R_RenderView (player);
+    src = screens[0] + viewwindowy*SCREENWIDTH + viewwindowx;
+    for (y=0 ; y<scaledviewheight ; y++)
+	memcpy (otherview+y*SCREENWIDTH, src+y*SCREENWIDTH, scaledviewwidth);
+
+    floatrender = wasfloat;
+    R_RenderView (player);
+
+    diffs = 0;
+    for (y=0 ; y<scaledviewheight ; y++)
+    {
+	src = otherview + y*SCREENWIDTH;
+	dest = screens[0] + (viewwindowy+y)*SCREENWIDTH + viewwindowx;
+	for (x=0 ; x<scaledviewwidth ; x++)
+	    diffs += src[x] != dest[x];
+    }
+    M_ProfCount (pc_floatdiffs, diffs);
+}
+
+
+//
+// R_RenderPlayerView
+//
+void R_RenderPlayerView (player_t* player)
+{
+    unsigned	start;
+
+    start = I_GetTimeUS ();
+    if (multiview)
+	R_StartPlayerViews (player);
+
+    if (floatcompare)
+	R_CompareFloat (player);
+    else
+	R_RenderView (player);
+
+    if (multiview)
+	R_FinishViews ();
+
+    R_UpdateLitCache ();
+
+    // for I_FinishUpdate
+    V_MarkRect (viewwindowx, viewwindowy, scaledviewwidth, scaledviewheight);
+
+    if (renderbudget)
+	R_GovernScale (I_GetTimeUS () - start);
+}
@@ -35,8 +35,8 @@
 //
 // POV related.
 //
-extern fixed_t		viewcos;
-extern fixed_t		viewsin;
+extern VIEWSTATE fixed_t		viewcos;
+extern VIEWSTATE fixed_t		viewsin;
 
 extern int		viewwidth;
 extern int		viewheight;
@@ -54,8 +54,26 @@ extern fixed_t		projection;
 
 extern int		validcount;
 
-extern int		linecount;
-extern int		loopcount;
+// Render interpolation between tics.
+extern fixed_t		fractionaltic;
+
+// Set by -floatrender, walls, flats and sprites are
+//  projected in float instead of fixed point.
+// -floatcompare draws each view both ways,
+//  shows the float one and counts the pixels that differ.
+extern VIEWSTATE boolean		floatrender;
+extern boolean		floatcompare;
+
+// The view for the float renderer.
+extern VIEWSTATE float		viewxf;
+extern VIEWSTATE float		viewyf;
+extern VIEWSTATE float		viewcosf;
+extern VIEWSTATE float		viewsinf;
+
+extern VIEWSTATE boolean	mainview;
+
+extern VIEWSTATE int		linecount;
+extern VIEWSTATE int		loopcount;
 
 
 //
@@ -75,11 +93,11 @@ extern int		loopcount;
 #define LIGHTZSHIFT		20
 
 extern lighttable_t*	scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
-extern lighttable_t*	scalelightfixed[MAXLIGHTSCALE];
+extern VIEWSTATE lighttable_t*	scalelightfixed[MAXLIGHTSCALE];
 extern lighttable_t*	zlight[LIGHTLEVELS][MAXLIGHTZ];
 
-extern int		extralight;
-extern lighttable_t*	fixedcolormap;
+extern VIEWSTATE int		extralight;
+extern VIEWSTATE lighttable_t*	fixedcolormap;
 
 
 // Number of diminishing brightness levels.
@@ -92,16 +110,31 @@ extern lighttable_t*	fixedcolormap;
 //  0 = high, 1 = low
 extern	int		detailshift;	
 
+// Internal resolution, in eighths of the view window.
+#define VIEWSCALEMIN		4
+#define VIEWSCALEMAX		8
+extern	int		viewscale;
+
+// R_RenderPlayerView time, in microseconds,
+//  that viewscale is stepped to hold.
+// 0 leaves it at full scale.
+extern	int		renderbudget;
+
 
 //
 // Function pointers to switch refresh/drawing functions.
 // Used to select shadow mode etc.
 //
-extern void		(*colfunc) (void);
+extern VIEWSTATE void	(*colfunc) (void);
 extern void		(*basecolfunc) (void);
 extern void		(*fuzzcolfunc) (void);
+extern void		(*transcolfunc) (void);
+extern void		(*skycolfunc) (void);
+extern void		(*litcolfunc) (void);
+extern void		(*mipcolfunc) (void);
 // No shadow effects on floors.
 extern void		(*spanfunc) (void);
+extern void		(*mipspanfunc) (void);
 
 
 //
@@ -138,6 +171,16 @@ R_PointToDist
 
 fixed_t R_ScaleFromGlobalAngle (angle_t visangle);
 
+fixed_t
+R_InterpolateCoord
+( fixed_t	oldval,
+  fixed_t	newval );
+
+angle_t
+R_InterpolateAngle
+( angle_t	oldval,
+  angle_t	newval );
+
 subsector_t*
 R_PointInSubsector
 ( fixed_t	x,
@@ -158,6 +201,9 @@ R_AddPointToBox
 // Called by G_Drawer.
 void R_RenderPlayerView (player_t *player);
 
+// Sets up the view from player, on the calling thread.
+void R_SetupFrame (player_t* player);
+
 // Called by startup code.
 void R_Init (void);
 
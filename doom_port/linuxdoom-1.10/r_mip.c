@@ -0,0 +1,369 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Mip mapping.
+//	Far walls and flats step over several texels a pixel,
+//	 each from another column or row, so they shimmer and
+//	 miss the cache. Each level averages 2x2 texels of the
+//	 one above in RGB, back to the nearest palette color.
+//	Flats get their levels at startup, wall textures when
+//	 a map using them is loaded.
+//
+//-----------------------------------------------------------------------------
+
+static const char
+rcsid[] = "$Id:$";
+
+
+#include <string.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+
+#include "z_zone.h"
+#include "i_system.h"
+#include "w_wad.h"
+#include "m_argv.h"
+
+#include "r_local.h"
+#include "p_spec.h"
+
+#ifdef __GNUG__
+#pragma implementation "r_mip.h"
+#endif
+#include "r_mip.h"
+
+
+extern int		numtextures;
+extern int		numflats;
+
+
+// Rows of a wall column, as many as the drawers wrap at.
+#define MIPHEIGHT		128
+
+// Walls narrower than this aren't worth it.
+#define MIPMINWIDTH		(1<<MIPLEVELS)
+
+
+boolean			mipmapping;
+
+static byte*		palette;
+
+// nearest palette color, 5 bits of each of r, g and b
+static byte		rgbtopal[32*32*32];
+
+// all levels of a texture in one block, level 1 first,
+//  PU_LEVEL so they go with the map
+static byte**		texturemips;
+
+// numflats*MIPLEVELS
+static byte**		flatmips;
+
+
+
+//
+// R_InitRGBToPal
+//
+static void R_InitRGBToPal (void)
+{
+    int		i;
+    int		c;
+    int		r;
+    int		g;
+    int		b;
+    int		dist;
+    int		best;
+    int		bestdist;
+    byte*	rgb;
+
+    for (i=0 ; i<32*32*32 ; i++)
+    {
+	bestdist = 0x7fffffff;
+	best = 0;
+	rgb = palette;
+	for (c=0 ; c<256 ; c++, rgb+=3)
+	{
+	    r = rgb[0] - (((i>>10)<<3)+4);
+	    g = rgb[1] - ((((i>>5)&31)<<3)+4);
+	    b = rgb[2] - (((i&31)<<3)+4);
+	    dist = r*r + g*g + b*b;
+	    if (dist < bestdist)
+	    {
+		bestdist = dist;
+		best = c;
+	    }
+	}
+	rgbtopal[i] = best;
+    }
+}
+
+
+//
+// R_MipColor
+// The average of sum, shift is log2 of the count.
+//
+static byte R_MipColor (int* sum, int shift)
+{
+    return rgbtopal[((sum[0]>>shift)>>3)<<10
+		    | ((sum[1]>>shift)>>3)<<5
+		    | ((sum[2]>>shift)>>3)];
+}
+
+
+//
+// R_MipFlat
+//
+static void
+R_MipFlat
+( byte*		source,
+  int		level,
+  byte*		dest )
+{
+    int		sums[64][3];
+    int		size;
+    int		x;
+    int		y;
+    byte*	rgb;
+
+    size = 64>>level;
+    for (y=0 ; y<size ; y++)
+    {
+	memset (sums, 0, sizeof(sums));
+	for (x=0 ; x<64<<level ; x++)
+	{
+	    // the rows of this mip row, one after another
+	    rgb = palette + source[((y<<level)+(x>>6))*64 + (x&63)]*3;
+	    sums[(x&63)>>level][0] += rgb[0];
+	    sums[(x&63)>>level][1] += rgb[1];
+	    sums[(x&63)>>level][2] += rgb[2];
+	}
+	for (x=0 ; x<size ; x++)
+	    *dest++ = R_MipColor (sums[x], level*2);
+    }
+}
+
+
+//
+// R_MipTexture
+//
+static void
+R_MipTexture
+( int		tex,
+  int		level,
+  byte*		dest )
+{
+    int		sums[MIPHEIGHT][3];
+    int		width;
+    int		col;
+    int		k;
+    int		y;
+    byte*	source;
+    byte*	rgb;
+
+    width = (texturewidthmask[tex]+1)>>level;
+    for (col=0 ; col<width ; col++)
+    {
+	memset (sums, 0, sizeof(sums));
+	for (k=0 ; k<1<<level ; k++)
+	{
+	    source = R_GetColumn (tex, (col<<level)+k);
+	    for (y=0 ; y<MIPHEIGHT ; y++)
+	    {
+		rgb = palette + source[y]*3;
+		sums[y>>level][0] += rgb[0];
+		sums[y>>level][1] += rgb[1];
+		sums[y>>level][2] += rgb[2];
+	    }
+	}
+	for (y=0 ; y<MIPHEIGHT>>level ; y++)
+	    *dest++ = R_MipColor (sums[y], level*2);
+    }
+}
+
+
+//
+// R_MipTextureSize
+// Bytes of all levels of a texture.
+//
+static int R_MipTextureSize (int tex)
+{
+    int		width;
+    int		size;
+    int		level;
+
+    width = texturewidthmask[tex]+1;
+    size = 0;
+    for (level=1 ; level<=MIPLEVELS ; level++)
+	size += (width>>level)*(MIPHEIGHT>>level);
+    return size;
+}
+
+
+
+//
+// R_InitMips
+//
+void R_InitMips (void)
+{
+    byte*	source;
+    byte*	dest;
+    int		i;
+    int		level;
+
+    mipmapping = M_CheckParm ("-mipmap");
+    if (!mipmapping)
+	return;
+
+    palette = W_CacheLumpName ("PLAYPAL", PU_STATIC);
+    R_InitRGBToPal ();
+
+    texturemips = Z_Malloc (numtextures*sizeof(*texturemips), PU_STATIC, 0);
+    memset (texturemips, 0, numtextures*sizeof(*texturemips));
+
+    // the markers between flats have no levels
+    flatmips = Z_Malloc (numflats*MIPLEVELS*sizeof(*flatmips), PU_STATIC, 0);
+    memset (flatmips, 0, numflats*MIPLEVELS*sizeof(*flatmips));
+    for (i=0 ; i<numflats ; i++)
+    {
+	if (W_LumpLength (firstflat+i) < 64*64)
+	    continue;
+
+	source = W_CacheLumpNum (firstflat+i, PU_STATIC);
+	for (level=1 ; level<=MIPLEVELS ; level++)
+	{
+	    dest = Z_Malloc ((64>>level)*(64>>level), PU_STATIC, 0);
+	    R_MipFlat (source, level, dest);
+	    flatmips[i*MIPLEVELS + level-1] = dest;
+	}
+	Z_ChangeTag (source, PU_CACHE);
+    }
+}
+
+
+
+//
+// R_InitLevelMips
+// Textures a map's walls animate to are made too,
+//  switches turned on fall back to the texture itself.
+//
+void R_InitLevelMips (void)
+{
+    byte*	present;
+    byte*	dest;
+    side_t*	side;
+    int		first;
+    int		last;
+    int		i;
+    int		j;
+    int		level;
+
+    if (!mipmapping)
+	return;
+
+    present = Z_Malloc (numtextures, PU_STATIC, 0);
+    memset (present, 0, numtextures);
+
+    for (i=0, side=sides ; i<numsides ; i++, side++)
+    {
+	present[side->toptexture] = 1;
+	present[side->midtexture] = 1;
+	present[side->bottomtexture] = 1;
+    }
+
+    for (i=1 ; i<numtextures ; i++)
+    {
+	if (present[i] != 1)
+	    continue;
+	P_AnimTextureRange (i, &first, &last);
+	for (j=first ; j<=last ; j++)
+	    present[j] |= 2;
+    }
+
+    // the last map's levels went with PU_LEVEL
+    for (i=1 ; i<numtextures ; i++)
+    {
+	if (!present[i]
+	    || texturewidthmask[i]+1 < MIPMINWIDTH
+	    || textureheight[i] < MIPHEIGHT<<FRACBITS)
+	    continue;
+
+	Z_Malloc (R_MipTextureSize (i), PU_LEVEL, &texturemips[i]);
+	dest = texturemips[i];
+	for (level=1 ; level<=MIPLEVELS ; level++)
+	{
+	    R_MipTexture (i, level, dest);
+	    dest += ((texturewidthmask[i]+1)>>level)*(MIPHEIGHT>>level);
+	}
+    }
+
+    Z_Free (present);
+}
+
+
+
+//
+// R_MipLevel
+//
+int R_MipLevel (unsigned step)
+{
+    int		level;
+
+    level = 0;
+    while (level < MIPLEVELS && step >= (unsigned)(2*FRACUNIT)<<level)
+	level++;
+    return level;
+}
+
+
+//
+// R_GetMipColumn
+//
+byte*
+R_GetMipColumn
+( int		tex,
+  int		col,
+  int		level )
+{
+    byte*	mip;
+    int		width;
+    int		i;
+
+    mip = texturemips[tex];
+    if (!mip)
+	return NULL;
+
+    width = texturewidthmask[tex]+1;
+    for (i=1 ; i<level ; i++)
+	mip += (width>>i)*(MIPHEIGHT>>i);
+
+    return mip + ((col & (width-1))>>level)*(MIPHEIGHT>>level);
+}
+
+
+//
+// R_GetMipFlat
+// NULL if the flat has no levels.
+//
+byte*
+R_GetMipFlat
+( int		flat,
+  int		level )
+{
+    return flatmips[flat*MIPLEVELS + level-1];
+}
@@ -0,0 +1,74 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Mip levels of wall textures and flats,
+//	 for surfaces far enough to skip texels.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __R_MIP__
+#define __R_MIP__
+
+#include "r_defs.h"
+
+#ifdef __GNUG__
+#pragma interface
+#endif
+
+
+// Levels below the texture itself,
+//  each half the size of the one above.
+#define MIPLEVELS		3
+
+
+// Set by -mipmap.
+extern boolean		mipmapping;
+
+
+// Called by R_Init, makes the flat levels.
+void R_InitMips (void);
+
+// Called by P_SetupLevel, makes the levels
+//  of the wall textures the map uses.
+void R_InitLevelMips (void);
+
+// 0 for the texture itself, up to MIPLEVELS,
+//  from the texels stepped a pixel.
+int R_MipLevel (unsigned step);
+
+// A column (128>>level) tall, or NULL
+//  if the texture has no levels.
+byte*
+R_GetMipColumn
+( int		tex,
+  int		col,
+  int		level );
+
+// (64>>level) square, or NULL.
+byte*
+R_GetMipFlat
+( int		flat,
+  int		level );
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
@@ -28,6 +28,7 @@ static const char
 rcsid[] = "$Id: r_plane.c,v 1.4 1997/02/03 16:47:55 b1 Exp $";
 
 #include <stdlib.h>
+#include <math.h>
 
 #include "i_system.h"
 #include "z_zone.h"
@@ -38,6 +39,7 @@ rcsid[] = "$Id: r_plane.c,v 1.4 1997/02/03 16:47:55 b1 Exp $";
 
 #include "r_local.h"
 #include "r_sky.h"
+#include "r_mip.h"
 
 
 
@@ -50,15 +52,15 @@ planefunction_t		ceilingfunc;
 
 // Here comes the obnoxious "visplane".
 #define MAXVISPLANES	128
-visplane_t		visplanes[MAXVISPLANES];
-visplane_t*		lastvisplane;
-visplane_t*		floorplane;
-visplane_t*		ceilingplane;
+VIEWSTATE visplane_t		visplanes[MAXVISPLANES];
+VIEWSTATE visplane_t*		lastvisplane;
+VIEWSTATE visplane_t*		floorplane;
+VIEWSTATE visplane_t*		ceilingplane;
 
 // ?
 #define MAXOPENINGS	SCREENWIDTH*64
-short			openings[MAXOPENINGS];
-short*			lastopening;
+VIEWSTATE short			openings[MAXOPENINGS];
+VIEWSTATE short*			lastopening;
 
 
 //
@@ -66,31 +68,64 @@ short*			lastopening;
 //  floorclip starts out SCREENHEIGHT
 //  ceilingclip starts out -1
 //
-short			floorclip[SCREENWIDTH];
-short			ceilingclip[SCREENWIDTH];
+VIEWSTATE short			floorclip[SCREENWIDTH];
+VIEWSTATE short			ceilingclip[SCREENWIDTH];
 
 //
 // spanstart holds the start of a plane span
 // initialized to 0 at start
 //
-int			spanstart[SCREENHEIGHT];
-int			spanstop[SCREENHEIGHT];
+VIEWSTATE int			spanstart[SCREENHEIGHT];
+VIEWSTATE int			spanstop[SCREENHEIGHT];
 
 //
 // texture mapping
 //
-lighttable_t**		planezlight;
-fixed_t			planeheight;
+VIEWSTATE lighttable_t**		planezlight;
+VIEWSTATE fixed_t			planeheight;
+
+// flat being drawn and its source, for mip mapping
+VIEWSTATE int			planeflat;
+VIEWSTATE byte*			planesource;
+
+//
+// Planes are drawn sorted by flat and light,
+//  the spans of a flat are batched up and then
+//  drawn in one go, with the flat in the cache.
+//
+#define MAXBATCHSPANS	1024
+
+typedef struct
+{
+    int			y;
+    int			x1;
+    int			x2;
+    fixed_t		xfrac;
+    fixed_t		yfrac;
+    fixed_t		xstep;
+    fixed_t		ystep;
+    lighttable_t*	colormap;
+    byte*		source;
+    int			mip;
+
+} batchspan_t;
+
+VIEWSTATE batchspan_t		batchspans[MAXBATCHSPANS];
+VIEWSTATE int			numbatchspans;
 
 fixed_t			yslope[SCREENHEIGHT];
 fixed_t			distscale[SCREENWIDTH];
-fixed_t			basexscale;
-fixed_t			baseyscale;
+VIEWSTATE fixed_t			basexscale;
+VIEWSTATE fixed_t			baseyscale;
+
+// float renderer
+VIEWSTATE float			planeheightf;
+float			yslopef[SCREENHEIGHT];
 
-fixed_t			cachedheight[SCREENHEIGHT];
-fixed_t			cacheddistance[SCREENHEIGHT];
-fixed_t			cachedxstep[SCREENHEIGHT];
-fixed_t			cachedystep[SCREENHEIGHT];
+VIEWSTATE fixed_t			cachedheight[SCREENHEIGHT];
+VIEWSTATE fixed_t			cacheddistance[SCREENHEIGHT];
+VIEWSTATE fixed_t			cachedxstep[SCREENHEIGHT];
+VIEWSTATE fixed_t			cachedystep[SCREENHEIGHT];
 
 
 
@@ -104,6 +139,134 @@ void R_InitPlanes (void)
 }
 
 
+//
+// R_FlushSpans
+//
+static void R_FlushSpans (void)
+{
+    batchspan_t*	span;
+    batchspan_t*	end;
+
+    end = batchspans + numbatchspans;
+    for (span = batchspans ; span < end ; span++)
+    {
+	ds_y = span->y;
+	ds_x1 = span->x1;
+	ds_x2 = span->x2;
+	ds_xfrac = span->xfrac;
+	ds_yfrac = span->yfrac;
+	ds_xstep = span->xstep;
+	ds_ystep = span->ystep;
+	ds_colormap = span->colormap;
+	ds_source = span->source;
+
+	if (span->mip)
+	{
+	    ds_mip = span->mip;
+	    mipspanfunc ();
+	}
+	else
+	{
+	    // high or low detail
+	    spanfunc ();
+	}
+    }
+    numbatchspans = 0;
+}
+
+
+//
+// R_MapSpan
+// Far rows step over texels, those are drawn
+//  from a mip level of the flat.
+//
+static void R_MapSpan (void)
+{
+    batchspan_t*	span;
+    byte*		mip;
+    fixed_t		xstep;
+    fixed_t		ystep;
+
+    if (numbatchspans == MAXBATCHSPANS)
+	R_FlushSpans ();
+
+    span = &batchspans[numbatchspans++];
+    span->y = ds_y;
+    span->x1 = ds_x1;
+    span->x2 = ds_x2;
+    span->xfrac = ds_xfrac;
+    span->yfrac = ds_yfrac;
+    span->xstep = ds_xstep;
+    span->ystep = ds_ystep;
+    span->colormap = ds_colormap;
+    span->source = planesource;
+    span->mip = 0;
+
+    if (mipmapping)
+    {
+	xstep = abs (ds_xstep);
+	ystep = abs (ds_ystep);
+	span->mip = R_MipLevel (xstep > ystep ? xstep : ystep);
+	if (span->mip && (mip = R_GetMipFlat (planeflat, span->mip)))
+	    span->source = mip;
+	else
+	    span->mip = 0;
+    }
+}
+
+
+//
+// R_MapPlaneFloat
+// The span starts where the ray through the left edge
+//  of column x1 meets the plane, (centerx-x1)/centerx
+//  to the left of straight ahead.
+//
+void
+R_MapPlaneFloat
+( int		y,
+  int		x1,
+  int		x2 )
+{
+    float	distance;
+    float	t;
+    float	x;
+    float	yy;
+    unsigned	index;
+
+    distance = planeheightf*yslopef[y];
+    t = (float)(centerx-x1)/centerx;
+    x = viewxf + distance*(viewcosf - t*viewsinf);
+    yy = viewyf + distance*(viewsinf + t*viewcosf);
+
+    // only the position in the 64 unit flat matters,
+    //  and that keeps it in fixed point range
+    x -= 64*floorf (x*(1.0f/64));
+    yy -= 64*floorf (yy*(1.0f/64));
+    ds_xfrac = x*FRACUNIT;
+    ds_yfrac = -yy*FRACUNIT;
+    ds_xstep = distance*viewsinf/centerx*FRACUNIT;
+    ds_ystep = distance*viewcosf/centerx*FRACUNIT;
+
+    if (fixedcolormap)
+	ds_colormap = fixedcolormap;
+    else
+    {
+	if (distance >= MAXLIGHTZ<<(LIGHTZSHIFT-FRACBITS))
+	    index = MAXLIGHTZ-1;
+	else
+	    index = distance*(1.0f/(1<<(LIGHTZSHIFT-FRACBITS)));
+
+	ds_colormap = planezlight[index];
+    }
+	
+    ds_y = y;
+    ds_x1 = x1;
+    ds_x2 = x2;
+
+    R_MapSpan ();
+}
+
+
 //
 // R_MapPlane
 //
@@ -138,6 +301,12 @@ R_MapPlane
     }
 #endif
 
+    if (floatrender)
+    {
+	R_MapPlaneFloat (y, x1, x2);
+	return;
+    }
+
     if (planeheight != cachedheight[y])
     {
 	cachedheight[y] = planeheight;
@@ -173,8 +342,7 @@ R_MapPlane
     ds_x1 = x1;
     ds_x2 = x2;
 
-    // high or low detail
-    spanfunc ();	
+    R_MapSpan ();
 }
 
 
@@ -360,14 +528,33 @@ R_MakeSpans
 
 
 
+//
+// R_ReleaseFlat
+// Done with planesource once its spans are drawn.
+//
+static void R_ReleaseFlat (void)
+{
+    R_FlushSpans ();
+    if (planesource && !holdcache)
+	Z_ChangeTag (planesource, PU_CACHE);
+    planesource = NULL;
+}
+
+
 //
 // R_DrawPlanes
 // At the end of each frame.
 //
 void R_DrawPlanes (void)
 {
+    visplane_t*		sorted[MAXVISPLANES];
     visplane_t*		pl;
+    int			numplanes;
+    int			flat;
+    int			other;
     int			light;
+    int			i;
+    int			j;
     int			x;
     int			stop;
     int			angle;
@@ -386,11 +573,32 @@ void R_DrawPlanes (void)
 		 lastopening - openings);
 #endif
 
+    // by flat, then light
+    numplanes = 0;
     for (pl = visplanes ; pl < lastvisplane ; pl++)
     {
 	if (pl->minx > pl->maxx)
 	    continue;
 
+	flat = viewflattranslation[pl->picnum];
+	for (j=numplanes ; j>0 ; j--)
+	{
+	    other = viewflattranslation[sorted[j-1]->picnum];
+	    if (other < flat
+		|| (other == flat && sorted[j-1]->lightlevel <= pl->lightlevel))
+		break;
+	    sorted[j] = sorted[j-1];
+	}
+	sorted[j] = pl;
+	numplanes++;
+    }
+
+    planeflat = -1;
+    planesource = NULL;
+
+    for (i=0 ; i<numplanes ; i++)
+    {
+	pl = sorted[i];
 	
 	// sky flat
 	if (pl->picnum == skyflatnum)
@@ -401,8 +609,8 @@ void R_DrawPlanes (void)
 	    //  i.e. colormaps[0] is used.
 	    // Because of this hack, sky is not affected
 	    //  by INVUL inverse mapping.
-	    dc_colormap = colormaps;
-	    dc_texturemid = skytexturemid;
+	    // The columns are scaled and lit up front,
+	    //  drawing them is a straight copy.
 	    for (x=pl->minx ; x <= pl->maxx ; x++)
 	    {
 		dc_yl = pl->top[x];
@@ -412,19 +620,27 @@ void R_DrawPlanes (void)
 		{
 		    angle = (viewangle + xtoviewangle[x])>>ANGLETOSKYSHIFT;
 		    dc_x = x;
-		    dc_source = R_GetColumn(skytexture, angle);
-		    colfunc ();
+		    dc_source = R_SkyColumn (angle, dc_iscale);
+		    skycolfunc ();
 		}
 	    }
 	    continue;
 	}
 	
-	// regular flat
-	ds_source = W_CacheLumpNum(firstflat +
-				   flattranslation[pl->picnum],
-				   PU_STATIC);
+	// regular flat, cached once for all its planes
+	flat = viewflattranslation[pl->picnum];
+	if (flat != planeflat)
+	{
+	    R_ReleaseFlat ();
+	    planeflat = flat;
+	    if (holdcache)
+		planesource = R_HoldLump (firstflat + planeflat);
+	    else
+		planesource = W_CacheLumpNum(firstflat + planeflat, PU_STATIC);
+	}
 	
 	planeheight = abs(pl->height-viewz);
+	planeheightf = (float)planeheight/FRACUNIT;
 	light = (pl->lightlevel >> LIGHTSEGSHIFT)+extralight;
 
 	if (light >= LIGHTLEVELS)
@@ -447,7 +663,7 @@ void R_DrawPlanes (void)
 			pl->top[x],
 			pl->bottom[x]);
 	}
-	
-	Z_ChangeTag (ds_source, PU_CACHE);
     }
+
+    R_ReleaseFlat ();
 }
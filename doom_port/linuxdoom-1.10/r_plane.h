@@ -32,7 +32,10 @@
 
 
 // Visplane related.
-extern  short*		lastopening;
+extern  VIEWSTATE short*		lastopening;
+
+extern VIEWSTATE visplane_t	visplanes[];
+extern VIEWSTATE visplane_t*	lastvisplane;
 
 
 typedef void (*planefunction_t) (int top, int bottom);
@@ -40,10 +43,11 @@ typedef void (*planefunction_t) (int top, int bottom);
 extern planefunction_t	floorfunc;
 extern planefunction_t	ceilingfunc_t;
 
-extern short		floorclip[SCREENWIDTH];
-extern short		ceilingclip[SCREENWIDTH];
+extern VIEWSTATE short		floorclip[SCREENWIDTH];
+extern VIEWSTATE short		ceilingclip[SCREENWIDTH];
 
 extern fixed_t		yslope[SCREENHEIGHT];
+extern float		yslopef[SCREENHEIGHT];
 extern fixed_t		distscale[SCREENWIDTH];
 
 void R_InitPlanes (void);
@@ -0,0 +1,720 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Potentially visible set.
+//	The WAD nodes carry no minisegs, so subsectors do not know
+//	 their neighbours across partition lines. Sectors do,
+//	 through two sided LineDefs, so visibility is done
+//	 sector to sector and looked up by the subsector's sector.
+//	Heights are ignored, any door might open, so the set
+//	 only depends on the 2D layout and is kept in a cache file.
+//
+//-----------------------------------------------------------------------------
+
+static const char
+rcsid[] = "$Id:$";
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+
+#include "z_zone.h"
+#include "i_system.h"
+#include "m_argv.h"
+#include "m_misc.h"
+
+#include "r_local.h"
+#include "r_state.h"
+
+#ifdef __GNUG__
+#pragma implementation "r_pvs.h"
+#endif
+#include "r_pvs.h"
+
+
+byte*		pvsmatrix;
+byte*		pvsflooded;
+boolean		nopvs;
+
+// per node: something below might be visible
+// The node flags follow the viewer,
+//  so every thread drawing a view keeps its own.
+static VIEWSTATE byte*	pvsnodes;
+static VIEWSTATE int	pvssector = -1;
+static VIEWSTATE int	pvsnodelevel;
+static int		pvslevel;
+
+
+//
+// PVS BUILDING
+// A sight line leaves the source sector through one portal
+//  (a two sided LineDef) and crosses others on the way.
+// A straight line has to stab them all, so each portal
+//  passed narrows the wedge that the next ones are clipped to,
+//  as in the Quake vis tools, but in 2D.
+// Everything only ever errs on the visible side.
+//
+typedef struct
+{
+    // oriented so the far side is on the left
+    double	x1, y1;
+    double	x2, y2;
+    int		line;
+    int		tosector;
+
+} pvsportal_t;
+
+// keep a*x + b*y + c >= -PVS_EPSILON
+typedef struct
+{
+    double	a, b, c;
+
+} pvsplane_t;
+
+#define PVS_EPSILON	0.01
+#define MAXPVSDEPTH	256
+
+// give up and flood fill after this many portals per sector
+#define PVS_BUDGET	0x10000
+
+static pvsportal_t*	portals;
+static int*		firstportal;	// numsectors+1 entries
+
+// the source's, then one for each portal passed
+//  and up to four separators for it
+static pvsplane_t	planes[1+MAXPVSDEPTH*5];
+static int		numplanes;
+static byte*		lineonstack;
+
+static pvsportal_t*	source;
+static byte*		pvsrow;
+static int		steps;
+static int		budget;
+static boolean		overflow;
+
+
+//
+// PVS_MakePlane
+// Line through two points, normalized,
+//  positive on the side of (kx,ky).
+// False if degenerate.
+//
+static boolean
+PVS_MakePlane
+( double	x1,
+  double	y1,
+  double	x2,
+  double	y2,
+  double	kx,
+  double	ky,
+  pvsplane_t*	pl )
+{
+    double	len;
+    double	d;
+
+    pl->a = y1 - y2;
+    pl->b = x2 - x1;
+    len = sqrt (pl->a*pl->a + pl->b*pl->b);
+    if (len < PVS_EPSILON)
+	return false;
+    pl->a /= len;
+    pl->b /= len;
+    pl->c = -(pl->a*x1 + pl->b*y1);
+
+    d = pl->a*kx + pl->b*ky + pl->c;
+    if (d > -PVS_EPSILON && d < PVS_EPSILON)
+	return false;
+    if (d < 0)
+    {
+	pl->a = -pl->a;
+	pl->b = -pl->b;
+	pl->c = -pl->c;
+    }
+    return true;
+}
+
+
+//
+// PVS_ClipPortal
+// Clip a portal to all the planes on the stack.
+// False if nothing is left.
+//
+static boolean
+PVS_ClipPortal
+( pvsportal_t*	in,
+  pvsportal_t*	out )
+{
+    int		i;
+    double	d1;
+    double	d2;
+    double	f;
+    pvsplane_t*	pl;
+
+    *out = *in;
+    for (i=0, pl=planes ; i<numplanes ; i++, pl++)
+    {
+	d1 = pl->a*out->x1 + pl->b*out->y1 + pl->c + PVS_EPSILON;
+	d2 = pl->a*out->x2 + pl->b*out->y2 + pl->c + PVS_EPSILON;
+
+	if (d1 < 0 && d2 < 0)
+	    return false;
+	if (d1 >= 0 && d2 >= 0)
+	    continue;
+
+	f = d1 / (d1-d2);
+	if (d1 < 0)
+	{
+	    out->x1 += f*(out->x2-out->x1);
+	    out->y1 += f*(out->y2-out->y1);
+	}
+	else
+	{
+	    out->x2 = out->x1 + f*(out->x2-out->x1);
+	    out->y2 = out->y1 + f*(out->y2-out->y1);
+	}
+    }
+    return true;
+}
+
+
+//
+// PVS_AddSeparators
+// The lines from one end of the source to the other
+//  end of the pass portal bound what can be seen past it.
+//
+static void PVS_AddSeparators (pvsportal_t* pass)
+{
+    double	sx[2];
+    double	sy[2];
+    double	px[2];
+    double	py[2];
+    int		i;
+    int		j;
+    pvsplane_t	pl;
+    double	ds;
+    double	dp;
+
+    sx[0] = source->x1;	sy[0] = source->y1;
+    sx[1] = source->x2;	sy[1] = source->y2;
+    px[0] = pass->x1;	py[0] = pass->y1;
+    px[1] = pass->x2;	py[1] = pass->y2;
+
+    for (i=0 ; i<2 ; i++)
+    {
+	for (j=0 ; j<2 ; j++)
+	{
+	    // positive toward the other end of the pass portal
+	    if (!PVS_MakePlane (sx[i], sy[i], px[j], py[j],
+				px[j^1], py[j^1], &pl))
+		continue;
+
+	    // only a separator if the source is on the other side
+	    ds = pl.a*sx[i^1] + pl.b*sy[i^1] + pl.c;
+	    dp = pl.a*px[j^1] + pl.b*py[j^1] + pl.c;
+	    if (ds > -PVS_EPSILON || dp < PVS_EPSILON)
+		continue;
+
+	    planes[numplanes++] = pl;
+	}
+    }
+}
+
+
+//
+// PVS_Flow
+// Recursively follow the portals out of a sector
+//  that are still inside the wedge.
+//
+static void PVS_Flow (int sector, int depth)
+{
+    pvsportal_t*	p;
+    pvsportal_t*	end;
+    pvsportal_t		clipped;
+    int			saveplanes;
+
+    if (depth == MAXPVSDEPTH)
+    {
+	overflow = true;
+	return;
+    }
+
+    end = &portals[firstportal[sector+1]];
+    for (p = &portals[firstportal[sector]] ; p<end ; p++)
+    {
+	if (lineonstack[p->line])
+	    continue;
+
+	if (!PVS_ClipPortal (p, &clipped))
+	    continue;
+
+	pvsrow[p->tosector>>3] |= 1<<(p->tosector&7);
+
+	if (++steps > budget)
+	{
+	    overflow = true;
+	    return;
+	}
+
+	saveplanes = numplanes;
+
+	// Past this portal, on its far side.
+	// Clipped down to a point it makes no plane,
+	//  and the separators alone bound the wedge.
+	if (PVS_MakePlane (clipped.x1, clipped.y1, clipped.x2, clipped.y2,
+			   clipped.x1 - (clipped.y2-clipped.y1),
+			   clipped.y1 + (clipped.x2-clipped.x1),
+			   &planes[numplanes]))
+	    numplanes++;
+	PVS_AddSeparators (&clipped);
+
+	lineonstack[p->line] = 1;
+	PVS_Flow (p->tosector, depth+1);
+	lineonstack[p->line] = 0;
+
+	numplanes = saveplanes;
+	if (overflow)
+	    return;
+    }
+}
+
+
+//
+// PVS_Flood
+// Fallback when the portal walk gets too deep:
+//  everything connected counts as visible.
+// The row doubles as the visited set, so what
+//  the aborted walk marked is cleared first.
+//
+static void PVS_Flood (int from, int* stack)
+{
+    int			sp;
+    int			sector;
+    pvsportal_t*	p;
+    pvsportal_t*	end;
+
+    memset (pvsrow, 0, PVS_ROWBYTES(numsectors));
+    pvsrow[from>>3] |= 1<<(from&7);
+
+    sp = 0;
+    stack[sp++] = from;
+    while (sp)
+    {
+	sector = stack[--sp];
+	end = &portals[firstportal[sector+1]];
+	for (p = &portals[firstportal[sector]] ; p<end ; p++)
+	{
+	    if (pvsrow[p->tosector>>3] & (1<<(p->tosector&7)))
+		continue;
+	    pvsrow[p->tosector>>3] |= 1<<(p->tosector&7);
+	    stack[sp++] = p->tosector;
+	}
+    }
+}
+
+
+//
+// R_BuildPVS
+//
+static void R_BuildPVS (void)
+{
+    int			i;
+    int			j;
+    int			rowbytes;
+    int			numportals;
+    int*		fill;
+    int*		stack;
+    line_t*		li;
+    pvsportal_t*	p;
+    pvsportal_t*	end;
+    int			front;
+    int			back;
+    int			flooded;
+
+    rowbytes = PVS_ROWBYTES(numsectors);
+
+    // count the portals out of each sector
+    firstportal = Z_Malloc ((numsectors+1)*sizeof(int), PU_STATIC, 0);
+    memset (firstportal, 0, (numsectors+1)*sizeof(int));
+    for (i=0, li=lines ; i<numlines ; i++, li++)
+    {
+	if (!li->backsector || li->backsector == li->frontsector)
+	    continue;
+	firstportal[li->frontsector-sectors+1]++;
+	firstportal[li->backsector-sectors+1]++;
+    }
+    for (i=0 ; i<numsectors ; i++)
+	firstportal[i+1] += firstportal[i];
+    numportals = firstportal[numsectors];
+
+    portals = Z_Malloc (numportals*sizeof(*portals)+1, PU_STATIC, 0);
+    fill = Z_Malloc (numsectors*sizeof(int), PU_STATIC, 0);
+    memcpy (fill, firstportal, numsectors*sizeof(int));
+
+    // Front is on the right of v1->v2, so the back sector is
+    //  on the left and the front to back portal runs v1->v2.
+    for (i=0, li=lines ; i<numlines ; i++, li++)
+    {
+	if (!li->backsector || li->backsector == li->frontsector)
+	    continue;
+	front = li->frontsector - sectors;
+	back = li->backsector - sectors;
+
+	p = &portals[fill[front]++];
+	p->x1 = (double)li->v1->x / FRACUNIT;
+	p->y1 = (double)li->v1->y / FRACUNIT;
+	p->x2 = (double)li->v2->x / FRACUNIT;
+	p->y2 = (double)li->v2->y / FRACUNIT;
+	p->line = i;
+	p->tosector = back;
+
+	p = &portals[fill[back]++];
+	p->x1 = (double)li->v2->x / FRACUNIT;
+	p->y1 = (double)li->v2->y / FRACUNIT;
+	p->x2 = (double)li->v1->x / FRACUNIT;
+	p->y2 = (double)li->v1->y / FRACUNIT;
+	p->line = i;
+	p->tosector = front;
+    }
+    Z_Free (fill);
+
+    lineonstack = Z_Malloc (numlines, PU_STATIC, 0);
+    memset (lineonstack, 0, numlines);
+    stack = Z_Malloc ((numportals+1)*sizeof(int), PU_STATIC, 0);
+
+    memset (pvsmatrix, 0, numsectors*rowbytes);
+    memset (pvsflooded, 0, numsectors);
+    flooded = 0;
+
+    for (i=0 ; i<numsectors ; i++)
+    {
+	pvsrow = pvsmatrix + i*rowbytes;
+	pvsrow[i>>3] |= 1<<(i&7);
+	steps = 0;
+	overflow = false;
+
+	end = &portals[firstportal[i+1]];
+	for (source = &portals[firstportal[i]] ; source<end ; source++)
+	{
+	    pvsrow[source->tosector>>3] |= 1<<(source->tosector&7);
+
+	    // the viewer can be anywhere on the near side
+	    numplanes = 0;
+	    if (PVS_MakePlane (source->x1, source->y1, source->x2, source->y2,
+			       source->x1 - (source->y2-source->y1),
+			       source->y1 + (source->x2-source->x1),
+			       &planes[numplanes]))
+		numplanes++;
+
+	    lineonstack[source->line] = 1;
+	    PVS_Flow (source->tosector, 0);
+	    lineonstack[source->line] = 0;
+
+	    if (overflow)
+		break;
+	}
+
+	if (overflow)
+	{
+	    memset (lineonstack, 0, numlines);
+	    PVS_Flood (i, stack);
+	    pvsflooded[i] = 1;
+	    flooded++;
+	}
+    }
+
+    // seeing is mutual, so take the union
+    for (i=0 ; i<numsectors ; i++)
+	for (j=0 ; j<i ; j++)
+	    if (PVS_VISIBLE(i,j) || PVS_VISIBLE(j,i))
+	    {
+		pvsmatrix[i*rowbytes+(j>>3)] |= 1<<(j&7);
+		pvsmatrix[j*rowbytes+(i>>3)] |= 1<<(i&7);
+	    }
+
+    if (flooded)
+	printf ("R_BuildPVS: %i sectors flood filled\n", flooded);
+
+    Z_Free (stack);
+    Z_Free (lineonstack);
+    Z_Free (portals);
+    Z_Free (firstportal);
+}
+
+
+//
+// R_CheckPVS
+// For -pvscheck: a flooded row has to hold
+//  every sector the two sided lines connect to it.
+// The groups are found from the lines,
+//  not from the portals the flood walked.
+//
+static int R_PVSGroup (int* group, int i)
+{
+    while (group[i] != i)
+    {
+	group[i] = group[group[i]];
+	i = group[i];
+    }
+    return i;
+}
+
+static void R_CheckPVS (void)
+{
+    int*	group;
+    int		i;
+    int		j;
+    int		a;
+    int		b;
+    int		rows;
+    line_t*	li;
+
+    group = Z_Malloc (numsectors*sizeof(int), PU_STATIC, 0);
+    for (i=0 ; i<numsectors ; i++)
+	group[i] = i;
+    for (i=0, li=lines ; i<numlines ; i++, li++)
+    {
+	if (!li->backsector)
+	    continue;
+	a = R_PVSGroup (group, li->frontsector-sectors);
+	b = R_PVSGroup (group, li->backsector-sectors);
+	group[a] = b;
+    }
+
+    rows = 0;
+    for (i=0 ; i<numsectors ; i++)
+    {
+	if (!pvsflooded[i])
+	    continue;
+	rows++;
+	a = R_PVSGroup (group, i);
+	for (j=0 ; j<numsectors ; j++)
+	    if (R_PVSGroup (group, j) == a && !PVS_VISIBLE(i,j))
+		I_Error ("R_CheckPVS: flooded sector %i misses sector %i",
+			 i, j);
+    }
+    Z_Free (group);
+
+    printf ("R_CheckPVS: %i flooded rows hold all they connect to\n",
+	    rows);
+}
+
+
+//
+// R_PVSHash
+// Only the 2D layout matters:
+//  vertexes, lines and which sectors they separate.
+//
+static unsigned R_PVSHash (void)
+{
+    unsigned	hash;
+    int		i;
+    int		v[4];
+    int		j;
+    line_t*	li;
+
+    hash = 2166136261u;
+    for (i=0, li=lines ; i<numlines ; i++, li++)
+    {
+	v[0] = li->v1->x;
+	v[1] = li->v1->y;
+	v[2] = li->v2->x;
+	v[3] = li->v2->y;
+	for (j=0 ; j<4 ; j++)
+	    hash = (hash ^ v[j]) * 16777619u;
+	hash = (hash ^ (li->frontsector ? li->frontsector-sectors : -1))
+	    * 16777619u;
+	hash = (hash ^ (li->backsector ? li->backsector-sectors : -1))
+	    * 16777619u;
+    }
+    hash = (hash ^ numsectors) * 16777619u;
+    return hash;
+}
+
+
+//
+// R_SetupPVS
+//
+typedef struct
+{
+    char	id[4];		// "PVS3"
+    unsigned	hash;
+    int		numsectors;
+
+    // then the matrix, then a byte per
+    //  sector that is set if it was flooded
+
+} pvsheader_t;
+
+void R_SetupPVS (void)
+{
+    char		name[16];
+    pvsheader_t*	header;
+    byte*		buffer;
+    int			length;
+    int			size;
+    int			total;
+    int			i;
+    int			j;
+
+    pvsmatrix = NULL;
+    pvsflooded = NULL;
+    pvslevel++;
+
+    if (nopvs || !numnodes)
+	return;
+
+    size = numsectors*PVS_ROWBYTES(numsectors);
+    pvsmatrix = Z_Malloc (size, PU_LEVEL, 0);
+    pvsflooded = Z_Malloc (numsectors, PU_LEVEL, 0);
+
+    // Every sector overflows a budget of one,
+    //  so the flood is all that gets checked.
+    if (M_CheckParm ("-pvscheck"))
+    {
+	budget = 1;
+	R_BuildPVS ();
+	R_CheckPVS ();
+    }
+
+    header = NULL;
+    sprintf (name, "%08x.pvs", R_PVSHash ());
+    if (!access (name, R_OK))
+    {
+	length = M_ReadFile (name, &buffer);
+	header = (pvsheader_t *)buffer;
+	if (length == sizeof(*header)+size+numsectors
+	    && !strncmp (header->id, "PVS3", 4)
+	    && header->numsectors == numsectors)
+	{
+	    memcpy (pvsmatrix, buffer+sizeof(*header), size);
+	    memcpy (pvsflooded, buffer+sizeof(*header)+size, numsectors);
+	    Z_Free (buffer);
+	    return;
+	}
+	Z_Free (buffer);
+    }
+
+    budget = PVS_BUDGET;
+    R_BuildPVS ();
+
+    // how much is left to walk, on average
+    total = 0;
+    for (i=0 ; i<numsectors ; i++)
+	for (j=0 ; j<numsectors ; j++)
+	    if (PVS_VISIBLE(i,j))
+		total++;
+    printf ("R_SetupPVS: %i sectors, %i%% potentially visible\n",
+	    numsectors, numsectors ? total*100/(numsectors*numsectors) : 0);
+
+    buffer = Z_Malloc (sizeof(*header)+size+numsectors, PU_STATIC, 0);
+    header = (pvsheader_t *)buffer;
+    memcpy (header->id, "PVS3", 4);
+    header->hash = R_PVSHash ();
+    header->numsectors = numsectors;
+    memcpy (buffer+sizeof(*header), pvsmatrix, size);
+    memcpy (buffer+sizeof(*header)+size, pvsflooded, numsectors);
+    if (!M_WriteFile (name, buffer, sizeof(*header)+size+numsectors))
+	printf ("R_SetupPVS: couldn't write %s\n", name);
+    Z_Free (buffer);
+}
+
+
+//
+// R_MarkPVSNodes
+// Flag the nodes that have a visible subsector below.
+//
+static boolean R_MarkPVSNodes (int bspnum)
+{
+    node_t*	bsp;
+    boolean	front;
+    boolean	back;
+
+    if (bspnum & NF_SUBSECTOR)
+    {
+	if (bspnum == -1)
+	    bspnum = 0;
+	else
+	    bspnum &= ~NF_SUBSECTOR;
+	return PVS_VISIBLE(pvssector, subsectors[bspnum].sector-sectors) != 0;
+    }
+
+    bsp = &nodes[bspnum];
+    front = R_MarkPVSNodes (bsp->children[0]);
+    back = R_MarkPVSNodes (bsp->children[1]);
+    pvsnodes[bspnum] = front || back;
+    return pvsnodes[bspnum];
+}
+
+
+//
+// R_SetupFramePVS
+// The node flags only change when the viewer
+//  walks into another sector.
+//
+void R_SetupFramePVS (void)
+{
+    int		sector;
+
+    if (!pvsmatrix)
+	return;
+
+    // first view of this thread on a new level
+    if (pvsnodelevel != pvslevel)
+    {
+	pvsnodes = realloc (pvsnodes, numnodes);
+	if (!pvsnodes)
+	    I_Error ("R_SetupFramePVS: couldn't flag %i nodes", numnodes);
+	pvsnodelevel = pvslevel;
+	pvssector = -1;
+    }
+
+    sector = R_PointInSubsector (viewx, viewy)->sector - sectors;
+    if (sector == pvssector)
+	return;
+
+    pvssector = sector;
+    R_MarkPVSNodes (numnodes-1);
+}
+
+
+//
+// R_NodeInPVS
+//
+boolean R_NodeInPVS (int bspnum)
+{
+    // Clipping through walls leaves the map,
+    //  the sector we are "in" means nothing then.
+    if (!pvsmatrix || (viewplayer->cheats & CF_NOCLIP))
+	return true;
+
+    if (bspnum & NF_SUBSECTOR)
+    {
+	if (bspnum == -1)
+	    bspnum = 0;
+	else
+	    bspnum &= ~NF_SUBSECTOR;
+	return PVS_VISIBLE(pvssector, subsectors[bspnum].sector-sectors) != 0;
+    }
+    return pvsnodes[bspnum];
+}
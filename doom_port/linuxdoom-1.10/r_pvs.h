@@ -0,0 +1,68 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Potentially visible set, sector to sector,
+//	 used to cull the BSP walk.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __R_PVS__
+#define __R_PVS__
+
+#include "doomtype.h"
+
+#ifdef __GNUG__
+#pragma interface
+#endif
+
+
+// numsectors*numsectors bits, row major,
+//  NULL if there is none for this level.
+extern byte*		pvsmatrix;
+
+// Per sector, set if its row was flood filled:
+//  the portal walk gave up and took everything connected.
+extern byte*		pvsflooded;
+
+// Set by -nopvs, for before/after comparisons.
+extern boolean		nopvs;
+
+#define PVS_ROWBYTES(n)		(((n)+7)>>3)
+#define PVS_VISIBLE(from,to)	\
+    (pvsmatrix[(from)*PVS_ROWBYTES(numsectors)+((to)>>3)] & (1<<((to)&7)))
+
+
+// Called by P_SetupLevel after P_GroupLines.
+// Loads the PVS from its cache file,
+//  or builds and saves it.
+// -pvscheck floods every row first and checks them.
+void R_SetupPVS (void);
+
+// Called by R_RenderPlayerView.
+void R_SetupFramePVS (void);
+
+// True if anything below the node might be visible.
+boolean R_NodeInPVS (int bspnum);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
@@ -30,6 +30,7 @@ rcsid[] = "$Id: r_segs.c,v 1.3 1997/01/29 20:10:19 b1 Exp $";
 
 
 #include <stdlib.h>
+#include <math.h>
 
 #include "i_system.h"
 
@@ -39,60 +40,92 @@ rcsid[] = "$Id: r_segs.c,v 1.3 1997/01/29 20:10:19 b1 Exp $";
 #include "r_local.h"
 #include "r_sky.h"
 
+#include "am_map.h"
+#include "r_snap.h"
+#include "r_lit.h"
+#include "r_mip.h"
+
 
 // OPTIMIZE: closed two sided lines as single sided
 
 // True if any of the segs textures might be visible.
-boolean		segtextured;	
+VIEWSTATE boolean		segtextured;	
 
 // False if the back side is the same plane.
-boolean		markfloor;	
-boolean		markceiling;
+VIEWSTATE boolean		markfloor;	
+VIEWSTATE boolean		markceiling;
 
-boolean		maskedtexture;
-int		toptexture;
-int		bottomtexture;
-int		midtexture;
+VIEWSTATE boolean		maskedtexture;
+VIEWSTATE int		toptexture;
+VIEWSTATE int		bottomtexture;
+VIEWSTATE int		midtexture;
 
 
-angle_t		rw_normalangle;
+VIEWSTATE angle_t		rw_normalangle;
 // angle to line origin
-int		rw_angle1;	
+VIEWSTATE int		rw_angle1;	
 
 //
 // regular wall
 //
-int		rw_x;
-int		rw_stopx;
-angle_t		rw_centerangle;
-fixed_t		rw_offset;
-fixed_t		rw_distance;
-fixed_t		rw_scale;
-fixed_t		rw_scalestep;
-fixed_t		rw_midtexturemid;
-fixed_t		rw_toptexturemid;
-fixed_t		rw_bottomtexturemid;
+VIEWSTATE int		rw_x;
+VIEWSTATE int		rw_stopx;
+VIEWSTATE angle_t		rw_centerangle;
+VIEWSTATE fixed_t		rw_offset;
+VIEWSTATE fixed_t		rw_distance;
+VIEWSTATE fixed_t		rw_scale;
+VIEWSTATE fixed_t		rw_scalestep;
+VIEWSTATE fixed_t		rw_midtexturemid;
+VIEWSTATE fixed_t		rw_toptexturemid;
+VIEWSTATE fixed_t		rw_bottomtexturemid;
+
+VIEWSTATE int		worldtop;
+VIEWSTATE int		worldbottom;
+VIEWSTATE int		worldhigh;
+VIEWSTATE int		worldlow;
+
+VIEWSTATE fixed_t		pixhigh;
+VIEWSTATE fixed_t		pixlow;
+VIEWSTATE fixed_t		pixhighstep;
+VIEWSTATE fixed_t		pixlowstep;
 
-int		worldtop;
-int		worldbottom;
-int		worldhigh;
-int		worldlow;
+VIEWSTATE fixed_t		topfrac;
+VIEWSTATE fixed_t		topstep;
 
-fixed_t		pixhigh;
-fixed_t		pixlow;
-fixed_t		pixhighstep;
-fixed_t		pixlowstep;
+VIEWSTATE fixed_t		bottomfrac;
+VIEWSTATE fixed_t		bottomstep;
 
-fixed_t		topfrac;
-fixed_t		topstep;
 
-fixed_t		bottomfrac;
-fixed_t		bottomstep;
+VIEWSTATE lighttable_t**	walllights;
+
+VIEWSTATE short*		maskedtexturecol;
+
+//
+// float renderer
+// With t = (centerx-x)/centerx the ray through column x
+//  is forward + t*left, so both its component into the wall (a)
+//  and along it (b) are linear in x.
+// Then scale = projection*a/distance,
+//  and the texture column is offset + distance*b/a.
+//
+VIEWSTATE float		rw_af;
+VIEWSTATE float		rw_astepf;
+VIEWSTATE float		rw_bf;
+VIEWSTATE float		rw_bstepf;
+VIEWSTATE float		rw_offsetf;
+VIEWSTATE float		rw_distancef;
+VIEWSTATE float		rw_scalemulf;
 
+VIEWSTATE float		worldtopf;
+VIEWSTATE float		worldbottomf;
+VIEWSTATE float		worldhighf;
+VIEWSTATE float		worldlowf;
 
-lighttable_t**	walllights;
+#define MINSCALEF	(256.0f/FRACUNIT)
+#define MAXSCALEF	64.0f
 
-short*		maskedtexturecol;
+// keeps the texture column finite along the edge of a wall
+#define MINAF		(1.0f/2048)
 
 
 
@@ -115,9 +148,9 @@ R_RenderMaskedSegRange
     //   for horizontal / vertical / diagonal. Diagonal?
     // OPTIMIZE: get rid of LIGHTSEGSHIFT globally
     curline = ds->curline;
-    frontsector = curline->frontsector;
-    backsector = curline->backsector;
-    texnum = texturetranslation[curline->sidedef->midtexture];
+    frontsector = VIEWSECTOR(curline->frontsector);
+    backsector = curline->backsector ? VIEWSECTOR(curline->backsector) : NULL;
+    texnum = viewtexturetranslation[VIEWSIDE(curline->sidedef)->midtexture];
 	
     lightnum = (frontsector->lightlevel >> LIGHTSEGSHIFT)+extralight;
 
@@ -153,7 +186,7 @@ R_RenderMaskedSegRange
 	    ? frontsector->ceilingheight : backsector->ceilingheight;
 	dc_texturemid = dc_texturemid - viewz;
     }
-    dc_texturemid += curline->sidedef->rowoffset;
+    dc_texturemid += VIEWSIDE(curline->sidedef)->rowoffset;
 			
     if (fixedcolormap)
 	dc_colormap = fixedcolormap;
@@ -181,7 +214,7 @@ R_RenderMaskedSegRange
 	    col = (column_t *)( 
 		(byte *)R_GetColumn(texnum,maskedtexturecol[dc_x]) -3);
 			
-	    R_DrawMaskedColumn (col);
+	    R_DrawMaskedColumn (R_DecodeColumn (col));
 	    maskedtexturecol[dc_x] = MAXSHORT;
 	}
 	spryscale += rw_scalestep;
@@ -192,6 +225,45 @@ R_RenderMaskedSegRange
 
 
 
+//
+// R_DrawWallColumn
+// Out of a mip level if the wall is far enough,
+//  or the lit cache if it has the texture
+//  at this light, dc_colormap set.
+//
+static void
+R_DrawWallColumn
+( int		texture,
+  int		texturecolumn )
+{
+    if (mipmapping)
+    {
+	dc_mip = R_MipLevel (dc_iscale);
+	if (dc_mip)
+	{
+	    dc_source = R_GetMipColumn (texture, texturecolumn, dc_mip);
+	    if (dc_source)
+	    {
+		mipcolfunc ();
+		return;
+	    }
+	}
+    }
+
+    if (litcache)
+    {
+	dc_source = R_GetLitColumn (texture, texturecolumn, dc_colormap);
+	if (dc_source)
+	{
+	    litcolfunc ();
+	    return;
+	}
+    }
+    dc_source = R_GetColumn (texture, texturecolumn);
+    colfunc ();
+}
+
+
 //
 // R_RenderSegLoop
 // Draws zero, one, or two textures (and possibly a masked
@@ -283,8 +355,7 @@ void R_RenderSegLoop (void)
 	    dc_yl = yl;
 	    dc_yh = yh;
 	    dc_texturemid = rw_midtexturemid;
-	    dc_source = R_GetColumn(midtexture,texturecolumn);
-	    colfunc ();
+	    R_DrawWallColumn (midtexture, texturecolumn);
 	    ceilingclip[rw_x] = viewheight;
 	    floorclip[rw_x] = -1;
 	}
@@ -305,8 +376,7 @@ void R_RenderSegLoop (void)
 		    dc_yl = yl;
 		    dc_yh = mid;
 		    dc_texturemid = rw_toptexturemid;
-		    dc_source = R_GetColumn(toptexture,texturecolumn);
-		    colfunc ();
+		    R_DrawWallColumn (toptexture, texturecolumn);
 		    ceilingclip[rw_x] = mid;
 		}
 		else
@@ -334,9 +404,7 @@ void R_RenderSegLoop (void)
 		    dc_yl = mid;
 		    dc_yh = yh;
 		    dc_texturemid = rw_bottomtexturemid;
-		    dc_source = R_GetColumn(bottomtexture,
-					    texturecolumn);
-		    colfunc ();
+		    R_DrawWallColumn (bottomtexture, texturecolumn);
 		    floorclip[rw_x] = mid;
 		}
 		else
@@ -366,6 +434,234 @@ void R_RenderSegLoop (void)
 
 
 
+//
+// R_WallScaleFloat
+// Clamped like R_ScaleFromGlobalAngle.
+//
+float R_WallScaleFloat (int x)
+{
+    float	scale;
+
+    scale = (rw_af + x*rw_astepf)*rw_scalemulf;
+    if (scale > MAXSCALEF)
+	return MAXSCALEF;
+    if (!(scale >= MINSCALEF))
+	return MINSCALEF;
+    return scale;
+}
+
+
+//
+// R_RenderSegLoopFloat
+// R_RenderSegLoop, with every column worked out
+//  from scratch in float instead of stepped in fixed point.
+//
+void R_RenderSegLoopFloat (void)
+{
+    unsigned		index;
+    int			yl;
+    int			yh;
+    int			mid;
+    fixed_t		texturecolumn;
+    int			top;
+    int			bottom;
+    float		scale;
+    float		a;
+    float		center;
+
+    texturecolumn = 0;
+    center = centery;
+
+    for ( ; rw_x < rw_stopx ; rw_x++)
+    {
+	scale = R_WallScaleFloat (rw_x);
+	rw_scale = scale*FRACUNIT;
+
+	// mark floor / ceiling areas
+	yl = ceilf (center - worldtopf*scale);
+
+	// no space above wall?
+	if (yl < ceilingclip[rw_x]+1)
+	    yl = ceilingclip[rw_x]+1;
+	
+	if (markceiling)
+	{
+	    top = ceilingclip[rw_x]+1;
+	    bottom = yl-1;
+
+	    if (bottom >= floorclip[rw_x])
+		bottom = floorclip[rw_x]-1;
+
+	    if (top <= bottom)
+	    {
+		ceilingplane->top[rw_x] = top;
+		ceilingplane->bottom[rw_x] = bottom;
+	    }
+	}
+		
+	yh = floorf (center - worldbottomf*scale);
+
+	if (yh >= floorclip[rw_x])
+	    yh = floorclip[rw_x]-1;
+
+	if (markfloor)
+	{
+	    top = yh+1;
+	    bottom = floorclip[rw_x]-1;
+	    if (top <= ceilingclip[rw_x])
+		top = ceilingclip[rw_x]+1;
+	    if (top <= bottom)
+	    {
+		floorplane->top[rw_x] = top;
+		floorplane->bottom[rw_x] = bottom;
+	    }
+	}
+	
+	// texturecolumn and lighting are independent of wall tiers
+	if (segtextured)
+	{
+	    a = rw_af + rw_x*rw_astepf;
+	    if (a < MINAF)
+		a = MINAF;
+	    texturecolumn = floorf (rw_offsetf
+				    + rw_distancef*(rw_bf + rw_x*rw_bstepf)/a);
+
+	    index = rw_scale>>LIGHTSCALESHIFT;
+
+	    if (index >=  MAXLIGHTSCALE )
+		index = MAXLIGHTSCALE-1;
+
+	    dc_colormap = walllights[index];
+	    dc_x = rw_x;
+	    dc_iscale = FRACUNIT/scale;
+	}
+	
+	// draw the wall tiers
+	if (midtexture)
+	{
+	    // single sided line
+	    dc_yl = yl;
+	    dc_yh = yh;
+	    dc_texturemid = rw_midtexturemid;
+	    R_DrawWallColumn (midtexture, texturecolumn);
+	    ceilingclip[rw_x] = viewheight;
+	    floorclip[rw_x] = -1;
+	}
+	else
+	{
+	    // two sided line
+	    if (toptexture)
+	    {
+		// top wall
+		mid = floorf (center - worldhighf*scale);
+
+		if (mid >= floorclip[rw_x])
+		    mid = floorclip[rw_x]-1;
+
+		if (mid >= yl)
+		{
+		    dc_yl = yl;
+		    dc_yh = mid;
+		    dc_texturemid = rw_toptexturemid;
+		    R_DrawWallColumn (toptexture, texturecolumn);
+		    ceilingclip[rw_x] = mid;
+		}
+		else
+		    ceilingclip[rw_x] = yl-1;
+	    }
+	    else
+	    {
+		// no top wall
+		if (markceiling)
+		    ceilingclip[rw_x] = yl-1;
+	    }
+			
+	    if (bottomtexture)
+	    {
+		// bottom wall
+		mid = ceilf (center - worldlowf*scale);
+
+		// no space above wall?
+		if (mid <= ceilingclip[rw_x])
+		    mid = ceilingclip[rw_x]+1;
+		
+		if (mid <= yh)
+		{
+		    dc_yl = mid;
+		    dc_yh = yh;
+		    dc_texturemid = rw_bottomtexturemid;
+		    R_DrawWallColumn (bottomtexture, texturecolumn);
+		    floorclip[rw_x] = mid;
+		}
+		else
+		    floorclip[rw_x] = yh+1;
+	    }
+	    else
+	    {
+		// no bottom wall
+		if (markfloor)
+		    floorclip[rw_x] = yh+1;
+	    }
+			
+	    if (maskedtexture)
+	    {
+		// save texturecol
+		//  for backdrawing of masked mid texture
+		maskedtexturecol[rw_x] = texturecolumn;
+	    }
+	}
+    }
+}
+
+
+//
+// R_SetupWallFloat
+// Everything R_RenderSegLoopFloat needs,
+//  and the drawseg's scales for sprite clipping.
+//
+void R_SetupWallFloat (void)
+{
+    float	dirx;
+    float	diry;
+    float	c0;
+    float	s0;
+    float	scale1;
+    float	scale2;
+
+    dirx = (float)curline->dirx/FRACUNIT;
+    diry = (float)curline->diry/FRACUNIT;
+
+    // a = s0 + t*c0, b = c0 - t*s0, t = 1 - x/centerx
+    c0 = dirx*viewcosf + diry*viewsinf;
+    s0 = dirx*viewsinf - diry*viewcosf;
+    rw_af = s0 + c0;
+    rw_astepf = -c0/centerx;
+    rw_bf = c0 - s0;
+    rw_bstepf = s0/centerx;
+
+    rw_distancef = (float)rw_distance/FRACUNIT;
+    rw_offsetf = (float)rw_offset/FRACUNIT;
+    if (rw_distance > 0)
+	rw_scalemulf = (centerx<<detailshift)/rw_distancef;
+    else
+	rw_scalemulf = 1e30f;
+
+    scale1 = R_WallScaleFloat (rw_x);
+    scale2 = R_WallScaleFloat (rw_stopx-1);
+    ds_p->scale1 = rw_scale = scale1*FRACUNIT;
+    ds_p->scale2 = scale2*FRACUNIT;
+    ds_p->scalestep = rw_scalestep = 0;
+    if (rw_stopx-1 > rw_x)
+	ds_p->scalestep = rw_scalestep =
+	    (ds_p->scale2 - ds_p->scale1) / (rw_stopx-1-rw_x);
+
+    worldtopf = (float)worldtop/FRACUNIT;
+    worldbottomf = (float)worldbottom/FRACUNIT;
+    worldhighf = (float)worldhigh/FRACUNIT;
+    worldlowf = (float)worldlow/FRACUNIT;
+}
+
+
 //
 // R_StoreWallRange
 // A wall segment will be drawn
@@ -376,9 +672,6 @@ R_StoreWallRange
 ( int	start,
   int	stop )
 {
-    fixed_t		hyp;
-    fixed_t		sineval;
-    angle_t		distangle, offsetangle;
     fixed_t		vtop;
     int			lightnum;
 
@@ -391,23 +684,26 @@ R_StoreWallRange
 	I_Error ("Bad R_RenderWallRange: %i to %i", start , stop);
 #endif
     
-    sidedef = curline->sidedef;
+    sidedef = VIEWSIDE(curline->sidedef);
     linedef = curline->linedef;
+    linecount++;
 
     // mark the segment as visible for auto map
-    linedef->flags |= ML_MAPPED;
+    if (mainview && !(linedef->flags & ML_MAPPED))
+    {
+	// the game is running on, it gets them afterwards
+	if (viewsnap)
+	    R_SnapLineSeen (linedef);
+	else
+	{
+	    linedef->flags |= ML_MAPPED;
+	    AM_LineSeen (linedef);
+	}
+    }
     
-    // calculate rw_distance for scale calculation
+    // rw_distance for the scale calculation
+    //  comes from R_AddLine.
     rw_normalangle = curline->angle + ANG90;
-    offsetangle = abs(rw_normalangle-rw_angle1);
-    
-    if (offsetangle > ANG90)
-	offsetangle = ANG90;
-
-    distangle = ANG90 - offsetangle;
-    hyp = R_PointToDist (curline->v1->x, curline->v1->y);
-    sineval = finesine[distangle>>ANGLETOFINESHIFT];
-    rw_distance = FixedMul (hyp, sineval);
 		
 	
     ds_p->x1 = rw_x = start;
@@ -456,7 +752,7 @@ R_StoreWallRange
     if (!backsector)
     {
 	// single sided line
-	midtexture = texturetranslation[sidedef->midtexture];
+	midtexture = viewtexturetranslation[sidedef->midtexture];
 	// a single sided line is terminal, so it must mark ends
 	markfloor = markceiling = true;
 	if (linedef->flags & ML_DONTPEGBOTTOM)
@@ -570,7 +866,7 @@ R_StoreWallRange
 	if (worldhigh < worldtop)
 	{
 	    // top texture
-	    toptexture = texturetranslation[sidedef->toptexture];
+	    toptexture = viewtexturetranslation[sidedef->toptexture];
 	    if (linedef->flags & ML_DONTPEGTOP)
 	    {
 		// top of texture at top
@@ -589,7 +885,7 @@ R_StoreWallRange
 	if (worldlow > worldbottom)
 	{
 	    // bottom texture
-	    bottomtexture = texturetranslation[sidedef->bottomtexture];
+	    bottomtexture = viewtexturetranslation[sidedef->bottomtexture];
 
 	    if (linedef->flags & ML_DONTPEGBOTTOM )
 	    {
@@ -618,19 +914,9 @@ R_StoreWallRange
 
     if (segtextured)
     {
-	offsetangle = rw_normalangle-rw_angle1;
-	
-	if (offsetangle > ANG180)
-	    offsetangle = -offsetangle;
-
-	if (offsetangle > ANG90)
-	    offsetangle = ANG90;
-
-	sineval = finesine[offsetangle >>ANGLETOFINESHIFT];
-	rw_offset = FixedMul (hyp, sineval);
-
-	if (rw_normalangle-rw_angle1 < ANG180)
-	    rw_offset = -rw_offset;
+	// how far along the seg the view point is
+	rw_offset = FixedMul (viewx - curline->v1->x, curline->dirx)
+		  + FixedMul (viewy - curline->v1->y, curline->diry);
 
 	rw_offset += sidedef->textureoffset + curline->offset;
 	rw_centerangle = ANG90 + viewangle - rw_normalangle;
@@ -676,6 +962,11 @@ R_StoreWallRange
     }
 
     
+    // the float renderer redoes the scales from the seg itself,
+    //  and has no use for the stepping below
+    if (floatrender)
+	R_SetupWallFloat ();
+
     // calculate incremental stepping values for texture edges
     worldtop >>= 4;
     worldbottom >>= 4;
@@ -711,7 +1002,10 @@ R_StoreWallRange
     if (markfloor)
 	floorplane = R_CheckPlane (floorplane, rw_x, rw_stopx-1);
 
-    R_RenderSegLoop ();
+    if (floatrender)
+	R_RenderSegLoopFloat ();
+    else
+	R_RenderSegLoop ();
 
     
     // save sprite clipping info
@@ -32,9 +32,13 @@ rcsid[] = "$Id: m_bbox.c,v 1.1 1997/02/03 22:45:10 b1 Exp $";
 // Needed for FRACUNIT.
 #include "m_fixed.h"
 
+#include "z_zone.h"
+
 // Needed for Flat retrieval.
 #include "r_data.h"
 
+#include "r_local.h"
+
 
 #ifdef __GNUG__
 #pragma implementation "r_sky.h"
@@ -48,6 +52,17 @@ int			skyflatnum;
 int			skytexture;
 int			skytexturemid;
 
+// Every sky column, scaled and lit for the view,
+//  viewheight bytes a column.
+static byte*		skycache;
+static int		skycachewidth;
+static int		skycacheheight;
+static int		skycachecentery;
+static fixed_t		skycacheiscale;
+
+// Set last, once the rest is built.
+static int		skycachetexture = -1;
+
 
 
 //
@@ -60,3 +75,77 @@ void R_InitSkyMap (void)
     skytexturemid = 100*FRACUNIT;
 }
 
+
+
+//
+// R_BuildSkyCache
+// The columns come out exactly as R_DrawColumn
+//  would draw them with colormaps[0].
+//
+static void R_BuildSkyCache (fixed_t iscale)
+{
+    byte*	source;
+    byte*	dest;
+    fixed_t	frac;
+    int		width;
+    int		col;
+    int		y;
+
+    width = texturewidthmask[skytexture]+1;
+    if (!skycache || width*viewheight > skycachewidth*skycacheheight)
+    {
+	if (skycache)
+	    Z_Free (skycache);
+	skycache = Z_Malloc (width*viewheight, PU_STATIC, 0);
+    }
+    skycachewidth = width;
+    skycacheheight = viewheight;
+    skycachecentery = centery;
+    skycacheiscale = iscale;
+
+    dest = skycache;
+    for (col=0 ; col<width ; col++)
+    {
+	source = R_GetColumn (skytexture, col);
+	frac = skytexturemid - centery*iscale;
+	for (y=0 ; y<viewheight ; y++)
+	{
+	    *dest++ = colormaps[source[(frac>>FRACBITS)&127]];
+	    frac += iscale;
+	}
+    }
+}
+
+
+//
+// R_SkyColumn
+// Rows 0 to viewheight-1 of a sky column,
+//  built again when the sky or the view size changes.
+// Views on other threads may ask at the same time.
+//
+byte*
+R_SkyColumn
+( int		col,
+  fixed_t	iscale )
+{
+    if (__atomic_load_n (&skycachetexture, __ATOMIC_ACQUIRE) != skytexture
+	|| skycacheheight != viewheight
+	|| skycachecentery != centery
+	|| skycacheiscale != iscale)
+    {
+	Z_Lock ();
+	if (skycachetexture != skytexture
+	    || skycacheheight != viewheight
+	    || skycachecentery != centery
+	    || skycacheiscale != iscale)
+	{
+	    skycachetexture = -1;
+	    R_BuildSkyCache (iscale);
+	    __atomic_store_n (&skycachetexture, skytexture, __ATOMIC_RELEASE);
+	}
+	Z_Unlock ();
+    }
+
+    return skycache + (col & (skycachewidth-1))*skycacheheight;
+}
+
@@ -40,6 +40,13 @@ extern int		skytexturemid;
 // Called whenever the view size changes.
 void R_InitSkyMap (void);
 
+// A sky texture column pre-scaled for the view,
+//  indexed by view row.
+byte*
+R_SkyColumn
+( int		col,
+  fixed_t	iscale );
+
 #endif
 //-----------------------------------------------------------------------------
 //
@@ -0,0 +1,316 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	World snapshots, for drawing the view while the game runs.
+//	The refresh only reads sectors, sides, the things linked
+//	 into sectors, the players and the animation translations
+//	 out of the world; the rest of the map doesn't change
+//	 until a new level is loaded.
+//	Tic N is copied, N+1 runs while a render thread draws N,
+//	 and the view of N is put up with the HUD of N+1.
+//	The game never waits on the refresh or reads anything
+//	 it writes, so demos play the same.
+//
+//-----------------------------------------------------------------------------
+
+static const char
+rcsid[] = "$Id:$";
+
+
+#include <string.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+
+#include "z_zone.h"
+#include "i_system.h"
+
+#include "r_local.h"
+#include "r_view.h"
+#include "r_lit.h"
+
+#include "am_map.h"
+#include "v_video.h"
+
+#ifdef __GNUG__
+#pragma implementation "r_snap.h"
+#endif
+#include "r_snap.h"
+
+
+extern int		numtextures;
+extern int		numflats;
+
+
+boolean			pipeline;
+VIEWSTATE snapshot_t*	viewsnap;
+
+static snapshot_t	snap;
+
+// displayed view of snap
+static byte*		snapbuffer;
+
+// shown this frame, to be started by R_StartSnapshot
+static player_t*	snapplayer;
+
+static boolean		snapbusy;
+static int		snapwaits;	// R_FinishSnapshot calls
+static int		snapstart;	// snapwaits when last started
+static int		snapwidth;
+static int		snapheight;
+static int		snapdetail;
+
+
+
+//
+// R_TakeSnapshot
+//
+static void R_TakeSnapshot (void)
+{
+    sector_t*	sec;
+    mobj_t*	mo;
+    mobj_t*	copy;
+    mobj_t**	link;
+    player_t*	player;
+    int		count;
+    int		i;
+
+    // level data goes with the level
+    if (!snap.sectors)
+    {
+	Z_Malloc (numsectors*sizeof(*snap.sectors), PU_LEVEL, &snap.sectors);
+	Z_Malloc (numsides*sizeof(*snap.sides), PU_LEVEL, &snap.sides);
+	Z_Malloc (numlines, PU_LEVEL, &snap.seen);
+	Z_Malloc (numlines*sizeof(*snap.seenlines), PU_LEVEL, &snap.seenlines);
+	memset (snap.seen, 0, numlines);
+	snap.numseen = 0;
+    }
+    if (!snap.texturetranslation)
+    {
+	snap.texturetranslation =
+	    Z_Malloc ((numtextures+1)*sizeof(int), PU_STATIC, 0);
+	snap.flattranslation =
+	    Z_Malloc ((numflats+1)*sizeof(int), PU_STATIC, 0);
+    }
+
+    memcpy (snap.sectors, sectors, numsectors*sizeof(*snap.sectors));
+    memcpy (snap.sides, sides, numsides*sizeof(*snap.sides));
+    memcpy (snap.texturetranslation, texturetranslation,
+	    (numtextures+1)*sizeof(int));
+    memcpy (snap.flattranslation, flattranslation,
+	    (numflats+1)*sizeof(int));
+    memcpy (snap.players, players, sizeof(snap.players));
+
+    // room for the things, and any player not in a sector
+    count = MAXPLAYERS;
+    for (i=0 ; i<numsectors ; i++)
+	for (mo = sectors[i].thinglist ; mo ; mo = mo->snext)
+	    count++;
+
+    if (!snap.mobjs || count > snap.maxmobjs)
+    {
+	if (snap.mobjs)
+	    Z_Free (snap.mobjs);
+	snap.maxmobjs = count + count/2;
+	Z_Malloc (snap.maxmobjs*sizeof(*snap.mobjs), PU_LEVEL, &snap.mobjs);
+    }
+
+    copy = snap.mobjs;
+    for (i=0, sec=sectors ; i<numsectors ; i++, sec++)
+    {
+	link = &snap.sectors[i].thinglist;
+	for (mo = sec->thinglist ; mo ; mo = mo->snext)
+	{
+	    *copy = *mo;
+	    *link = copy;
+	    link = &copy->snext;
+
+	    // voodoo dolls have a player too
+	    player = mo->player;
+	    if (player && player->mo == mo)
+		snap.players[player-players].mo = copy;
+	    copy++;
+	}
+	*link = NULL;
+    }
+
+    for (i=0 ; i<MAXPLAYERS ; i++)
+    {
+	mo = players[i].mo;
+	if (mo && snap.players[i].mo == mo)
+	{
+	    *copy = *mo;
+	    copy->snext = NULL;
+	    snap.players[i].mo = copy++;
+	}
+    }
+}
+
+
+
+//
+// R_BeginSnapshot
+//
+static void R_BeginSnapshot (player_t* player)
+{
+    viewjob_t	views[MAXPLAYERS];
+    int		count;
+    int		i;
+
+    R_TakeSnapshot ();
+
+    if (!snapbuffer)
+	snapbuffer = Z_Malloc (SCREENWIDTH*SCREENHEIGHT, PU_STATIC, NULL);
+
+    views[0].player = &snap.players[player-players];
+    views[0].buffer = snapbuffer;
+    views[0].snap = &snap;
+    views[0].mapping = true;
+    count = 1;
+
+    if (multiview)
+    {
+	for (i=0 ; i<MAXPLAYERS ; i++)
+	{
+	    if (!playeringame[i] || !players[i].mo || &players[i] == player)
+		continue;
+
+	    if (!viewbuffers[i])
+		viewbuffers[i] = Z_Malloc (SCREENWIDTH*SCREENHEIGHT,
+					   PU_STATIC, NULL);
+	    views[count].player = &snap.players[i];
+	    views[count].buffer = viewbuffers[i];
+	    views[count].snap = &snap;
+	    views[count].mapping = false;
+	    count++;
+	}
+    }
+
+    R_StartJobs (views, count);
+
+    snapbusy = true;
+    snapstart = snapwaits;
+    snapwidth = viewwidth;
+    snapheight = viewheight;
+    snapdetail = detailshift;
+}
+
+
+
+//
+// R_FinishSnapshot
+//
+void R_FinishSnapshot (void)
+{
+    line_t*	line;
+    int		i;
+
+    snapwaits++;
+    snapplayer = NULL;
+    if (!snapbusy)
+	return;
+
+    R_FinishViews ();
+    snapbusy = false;
+    R_UpdateLitCache ();
+
+    for (i=0 ; i<snap.numseen ; i++)
+    {
+	line = snap.seenlines[i];
+	snap.seen[line-lines] = 0;
+	if (!(line->flags & ML_MAPPED))
+	{
+	    line->flags |= ML_MAPPED;
+	    AM_LineSeen (line);
+	}
+    }
+    snap.numseen = 0;
+}
+
+
+
+//
+// R_SnapLineSeen
+// Only the displayed view maps, so only one thread is in here.
+//
+void R_SnapLineSeen (line_t* line)
+{
+    int		i;
+
+    i = line - lines;
+    if (viewsnap->seen[i])
+	return;
+
+    viewsnap->seen[i] = 1;
+    viewsnap->seenlines[viewsnap->numseen++] = line;
+}
+
+
+
+//
+// R_RenderSnapshotView
+// D_Display has just finished the last one.
+//
+void R_RenderSnapshotView (player_t* player)
+{
+    byte*	src;
+    byte*	dest;
+    int		y;
+
+    // The first frame, and those after a level load,
+    //  a new view size or a frame without a view
+    //  have nothing to put up yet.
+    if (snapwaits != snapstart+1
+	|| snapwidth != viewwidth
+	|| snapheight != viewheight
+	|| snapdetail != detailshift)
+    {
+	R_BeginSnapshot (player);
+	R_FinishSnapshot ();
+    }
+
+    src = snapbuffer;
+    dest = screens[0] + viewwindowy*SCREENWIDTH + viewwindowx;
+    for (y=0 ; y<viewheight ; y++)
+    {
+	memcpy (dest, src, viewwidth<<detailshift);
+	src += SCREENWIDTH;
+	dest += SCREENWIDTH;
+    }
+    V_MarkRect (viewwindowx, viewwindowy, scaledviewwidth, scaledviewheight);
+
+    snapplayer = player;
+}
+
+
+
+//
+// R_StartSnapshot
+// Not before the HUD and menus are drawn,
+//  they use PU_CACHE blocks the render thread could purge.
+//
+void R_StartSnapshot (void)
+{
+    if (!snapplayer)
+	return;
+
+    // draws while the next tics run
+    R_BeginSnapshot (snapplayer);
+    snapplayer = NULL;
+}
@@ -0,0 +1,90 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	A copy of what the refresh reads from the world,
+//	 so the view can be drawn while the next tics run.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __R_SNAP__
+#define __R_SNAP__
+
+#include "d_player.h"
+#include "r_defs.h"
+
+#ifdef __GNUG__
+#pragma interface
+#endif
+
+
+typedef struct
+{
+    // thinglists run through mobjs
+    sector_t*		sectors;
+    side_t*		sides;
+
+    mobj_t*		mobjs;
+    int			maxmobjs;
+
+    // mo points into mobjs
+    player_t		players[MAXPLAYERS];
+
+    // animated walls and flats
+    int*		texturetranslation;
+    int*		flattranslation;
+
+    // lines the displayed view has seen,
+    //  handed to the automap afterwards
+    byte*		seen;
+    line_t**		seenlines;
+    int			numseen;
+
+} snapshot_t;
+
+
+// Set by -pipeline, the view is drawn from a snapshot
+//  on another thread while the game runs on,
+//  and shown a frame late.
+extern boolean		pipeline;
+
+// What the view on this thread is drawn from,
+//  NULL for the live world.
+extern VIEWSTATE snapshot_t*	viewsnap;
+
+
+// Called by D_RenderView with -pipeline.
+void R_RenderSnapshotView (player_t* player);
+
+// Called by D_Display once the frame is drawn,
+//  the view put up starts drawing the next one.
+void R_StartSnapshot (void);
+
+// Called by D_Display and G_Ticker,
+//  before anything a snapshot view uses can change.
+void R_FinishSnapshot (void);
+
+// Called by R_StoreWallRange for a snapshot view.
+void R_SnapLineSeen (line_t* line);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
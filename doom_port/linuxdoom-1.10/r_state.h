@@ -43,6 +43,9 @@
 // needed for texture pegging
 extern fixed_t*		textureheight;
 
+// width-1, widths are powers of two
+extern int*		texturewidthmask;
+
 // needed for pre rendering (fracs)
 extern fixed_t*		spritewidth;
 
@@ -53,6 +56,7 @@ extern lighttable_t*	colormaps;
 
 extern int		viewwidth;
 extern int		scaledviewwidth;
+extern int		scaledviewheight;
 extern int		viewheight;
 
 extern int		firstflat;
@@ -97,15 +101,28 @@ extern int		numsides;
 extern side_t*		sides;
 
 
+//
+// The world as the view being drawn sees it,
+//  the arrays above or a snapshot of them.
+//
+extern VIEWSTATE sector_t*	viewsectors;
+extern VIEWSTATE side_t*	viewsides;
+extern VIEWSTATE int*		viewtexturetranslation;
+extern VIEWSTATE int*		viewflattranslation;
+
+#define VIEWSECTOR(sec)	(viewsectors + ((sec) - sectors))
+#define VIEWSIDE(side)	(viewsides + ((side) - sides))
+
+
 //
 // POV data.
 //
-extern fixed_t		viewx;
-extern fixed_t		viewy;
-extern fixed_t		viewz;
+extern VIEWSTATE fixed_t		viewx;
+extern VIEWSTATE fixed_t		viewy;
+extern VIEWSTATE fixed_t		viewz;
 
-extern angle_t		viewangle;
-extern player_t*	viewplayer;
+extern VIEWSTATE angle_t		viewangle;
+extern VIEWSTATE player_t*	viewplayer;
 
 
 // ?
@@ -115,19 +132,19 @@ extern int		viewangletox[FINEANGLES/2];
 extern angle_t		xtoviewangle[SCREENWIDTH+1];
 //extern fixed_t		finetangent[FINEANGLES/2];
 
-extern fixed_t		rw_distance;
-extern angle_t		rw_normalangle;
+extern VIEWSTATE fixed_t		rw_distance;
+extern VIEWSTATE angle_t		rw_normalangle;
 
 
 
 // angle to line origin
-extern int		rw_angle1;
+extern VIEWSTATE int		rw_angle1;
 
 // Segs count?
-extern int		sscount;
+extern VIEWSTATE int		sscount;
 
-extern visplane_t*	floorplane;
-extern visplane_t*	ceilingplane;
+extern VIEWSTATE visplane_t*	floorplane;
+extern VIEWSTATE visplane_t*	ceilingplane;
 
 
 #endif
@@ -28,6 +28,8 @@ rcsid[] = "$Id: r_things.c,v 1.5 1997/02/03 16:47:56 b1 Exp $";
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 
 
 #include "doomdef.h"
@@ -74,7 +76,7 @@ typedef struct
 fixed_t		pspritescale;
 fixed_t		pspriteiscale;
 
-lighttable_t**	spritelights;
+VIEWSTATE lighttable_t**	spritelights;
 
 // constant arrays
 //  used for psprite clipping and initializing clipping
@@ -286,9 +288,15 @@ void R_InitSpriteDefs (char** namelist)
 //
 // GAME FUNCTIONS
 //
-vissprite_t	vissprites[MAXVISSPRITES];
-vissprite_t*	vissprite_p;
-int		newvissprite;
+VIEWSTATE vissprite_t	vissprites[MAXVISSPRITES];
+VIEWSTATE vissprite_t*	vissprite_p;
+VIEWSTATE int		newvissprite;
+
+// sector->validcount is shared by every view,
+//  so each keeps its own marks of the sectors it has added.
+static VIEWSTATE int*	spritesectors;
+static VIEWSTATE int	numspritesectors;
+static VIEWSTATE int	spriteview;
 
 
 
@@ -317,13 +325,25 @@ void R_InitSprites (char** namelist)
 void R_ClearSprites (void)
 {
     vissprite_p = vissprites;
+
+    if (numspritesectors < numsectors)
+    {
+	spritesectors = realloc (spritesectors,
+				 numsectors*sizeof(*spritesectors));
+	if (!spritesectors)
+	    I_Error ("R_ClearSprites: couldn't mark %i sectors", numsectors);
+	memset (spritesectors, 0, numsectors*sizeof(*spritesectors));
+	numspritesectors = numsectors;
+	spriteview = 0;
+    }
+    spriteview++;
 }
 
 
 //
 // R_NewVisSprite
 //
-vissprite_t	overflowsprite;
+VIEWSTATE vissprite_t	overflowsprite;
 
 vissprite_t* R_NewVisSprite (void)
 {
@@ -342,26 +362,29 @@ vissprite_t* R_NewVisSprite (void)
 // Masked means: partly transparent, i.e. stored
 //  in posts/runs of opaque pixels.
 //
-short*		mfloorclip;
-short*		mceilingclip;
+VIEWSTATE short*		mfloorclip;
+VIEWSTATE short*		mceilingclip;
 
-fixed_t		spryscale;
-fixed_t		sprtopscreen;
+VIEWSTATE fixed_t		spryscale;
+VIEWSTATE fixed_t		sprtopscreen;
 
-void R_DrawMaskedColumn (column_t* column)
+void R_DrawMaskedColumn (rcolumn_t* column)
 {
     int		topscreen;
     int 	bottomscreen;
     fixed_t	basetexturemid;
+    rpost_t*	post;
+    int		i;
 	
     basetexturemid = dc_texturemid;
 	
-    for ( ; column->topdelta != 0xff ; ) 
+    post = column->posts;
+    for (i=0 ; i<column->numposts ; i++, post++) 
     {
 	// calculate unclipped screen coordinates
 	//  for post
-	topscreen = sprtopscreen + spryscale*column->topdelta;
-	bottomscreen = topscreen + spryscale*column->length;
+	topscreen = sprtopscreen + spryscale*post->topdelta;
+	bottomscreen = topscreen + spryscale*post->length;
 
 	dc_yl = (topscreen+FRACUNIT-1)>>FRACBITS;
 	dc_yh = (bottomscreen-1)>>FRACBITS;
@@ -373,15 +396,13 @@ void R_DrawMaskedColumn (column_t* column)
 
 	if (dc_yl <= dc_yh)
 	{
-	    dc_source = (byte *)column + 3;
-	    dc_texturemid = basetexturemid - (column->topdelta<<FRACBITS);
-	    // dc_source = (byte *)column + 3 - column->topdelta;
+	    dc_source = post->pixels;
+	    dc_texturemid = basetexturemid - (post->topdelta<<FRACBITS);
 
 	    // Drawn by either R_DrawColumn
 	    //  or (SHADOW) R_DrawFuzzColumn.
 	    colfunc ();	
 	}
-	column = (column_t *)(  (byte *)column + column->length + 4);
     }
 	
     dc_texturemid = basetexturemid;
@@ -399,13 +420,15 @@ R_DrawVisSprite
   int			x1,
   int			x2 )
 {
-    column_t*		column;
     int			texturecolumn;
     fixed_t		frac;
-    patch_t*		patch;
+    rpatch_t*		patch;
 	
 	
-    patch = W_CacheLumpNum (vis->patch+firstspritelump, PU_CACHE);
+    if (holdcache)
+	patch = R_HoldPatchNum (vis->patch+firstspritelump);
+    else
+	patch = R_CachePatchNum (vis->patch+firstspritelump);
 
     dc_colormap = vis->colormap;
     
@@ -416,7 +439,7 @@ R_DrawVisSprite
     }
     else if (vis->mobjflags & MF_TRANSLATION)
     {
-	colfunc = R_DrawTranslatedColumn;
+	colfunc = transcolfunc;
 	dc_translation = translationtables - 256 +
 	    ( (vis->mobjflags & MF_TRANSLATION) >> (MF_TRANSSHIFT-8) );
     }
@@ -431,12 +454,10 @@ R_DrawVisSprite
     {
 	texturecolumn = frac>>FRACBITS;
 #ifdef RANGECHECK
-	if (texturecolumn < 0 || texturecolumn >= SHORT(patch->width))
+	if (texturecolumn < 0 || texturecolumn >= patch->width)
 	    I_Error ("R_DrawSpriteRange: bad texturecolumn");
 #endif
-	column = (column_t *) ((byte *)patch +
-			       LONG(patch->columnofs[texturecolumn]));
-	R_DrawMaskedColumn (column);
+	R_DrawMaskedColumn (&patch->columns[texturecolumn]);
     }
 
     colfunc = basecolfunc;
@@ -478,29 +499,66 @@ void R_ProjectSprite (mobj_t* thing)
     
     angle_t		ang;
     fixed_t		iscale;
+
+    fixed_t		fx;
+    fixed_t		fy;
+    fixed_t		fz;
+
+    float		trxf;
+    float		tryf;
+    float		tzf;
+    float		txf;
+    float		xscalef;
     
-    // transform the origin point
-    tr_x = thing->x - viewx;
-    tr_y = thing->y - viewy;
+    // where the thing is between the last tic and this one
+    fx = R_InterpolateCoord (thing->oldx, thing->x);
+    fy = R_InterpolateCoord (thing->oldy, thing->y);
+    fz = R_InterpolateCoord (thing->oldz, thing->z);
+
+    txf = xscalef = 0;		// shut up compiler warning
+    if (floatrender)
+    {
+	trxf = (float)fx/FRACUNIT - viewxf;
+	tryf = (float)fy/FRACUNIT - viewyf;
+	tzf = trxf*viewcosf + tryf*viewsinf;
+
+	if (tzf < (float)MINZ/FRACUNIT)
+	    return;
+
+	xscalef = centerx/tzf;
+	txf = trxf*viewsinf - tryf*viewcosf;
+
+	if (fabsf (txf) > tzf*4)
+	    return;
+
+	xscale = xscalef*FRACUNIT;
+	tx = txf*FRACUNIT;
+    }
+    else
+    {
+	// transform the origin point
+	tr_x = fx - viewx;
+	tr_y = fy - viewy;
 	
-    gxt = FixedMul(tr_x,viewcos); 
-    gyt = -FixedMul(tr_y,viewsin);
+	gxt = FixedMul(tr_x,viewcos); 
+	gyt = -FixedMul(tr_y,viewsin);
     
-    tz = gxt-gyt; 
+	tz = gxt-gyt; 
 
-    // thing is behind view plane?
-    if (tz < MINZ)
-	return;
+	// thing is behind view plane?
+	if (tz < MINZ)
+	    return;
     
-    xscale = FixedDiv(projection, tz);
+	xscale = FixedDiv(projection, tz);
 	
-    gxt = -FixedMul(tr_x,viewsin); 
-    gyt = FixedMul(tr_y,viewcos); 
-    tx = -(gyt+gxt); 
+	gxt = -FixedMul(tr_x,viewsin); 
+	gyt = FixedMul(tr_y,viewcos); 
+	tx = -(gyt+gxt); 
 
-    // too far off the side?
-    if (abs(tx)>(tz<<2))
-	return;
+	// too far off the side?
+	if (abs(tx)>(tz<<2))
+	    return;
+    }
     
     // decide which patch to use for sprite relative to player
 #ifdef RANGECHECK
@@ -519,7 +577,7 @@ void R_ProjectSprite (mobj_t* thing)
     if (sprframe->rotate)
     {
 	// choose a different rotation based on player view
-	ang = R_PointToAngle (thing->x, thing->y);
+	ang = R_PointToAngle (fx, fy);
 	rot = (ang-thing->angle+(unsigned)(ANG45/2)*9)>>29;
 	lump = sprframe->lump[rot];
 	flip = (boolean)sprframe->flip[rot];
@@ -532,15 +590,27 @@ void R_ProjectSprite (mobj_t* thing)
     }
     
     // calculate edges of the shape
-    tx -= spriteoffset[lump];	
-    x1 = (centerxfrac + FixedMul (tx,xscale) ) >>FRACBITS;
+    if (floatrender)
+    {
+	txf -= (float)spriteoffset[lump]/FRACUNIT;
+	x1 = floorf (centerx + txf*xscalef);
+	if (x1 > viewwidth)
+	    return;
+	txf += (float)spritewidth[lump]/FRACUNIT;
+	x2 = floorf (centerx + txf*xscalef) - 1;
+    }
+    else
+    {
+	tx -= spriteoffset[lump];	
+	x1 = (centerxfrac + FixedMul (tx,xscale) ) >>FRACBITS;
 
-    // off the right side?
-    if (x1 > viewwidth)
-	return;
+	// off the right side?
+	if (x1 > viewwidth)
+	    return;
     
-    tx +=  spritewidth[lump];
-    x2 = ((centerxfrac + FixedMul (tx,xscale) ) >>FRACBITS) - 1;
+	tx +=  spritewidth[lump];
+	x2 = ((centerxfrac + FixedMul (tx,xscale) ) >>FRACBITS) - 1;
+    }
 
     // off the left side
     if (x2 < 0)
@@ -550,14 +620,17 @@ void R_ProjectSprite (mobj_t* thing)
     vis = R_NewVisSprite ();
     vis->mobjflags = thing->flags;
     vis->scale = xscale<<detailshift;
-    vis->gx = thing->x;
-    vis->gy = thing->y;
-    vis->gz = thing->z;
-    vis->gzt = thing->z + spritetopoffset[lump];
+    vis->gx = fx;
+    vis->gy = fy;
+    vis->gz = fz;
+    vis->gzt = fz + spritetopoffset[lump];
     vis->texturemid = vis->gzt - viewz;
     vis->x1 = x1 < 0 ? 0 : x1;
     vis->x2 = x2 >= viewwidth ? viewwidth-1 : x2;	
-    iscale = FixedDiv (FRACUNIT, xscale);
+    if (floatrender)
+	iscale = FRACUNIT/xscalef;
+    else
+	iscale = FixedDiv (FRACUNIT, xscale);
 
     if (flip)
     {
@@ -619,11 +692,12 @@ void R_AddSprites (sector_t* sec)
     // A sector might have been split into several
     //  subsectors during BSP building.
     // Thus we check whether its already added.
-    if (sec->validcount == validcount)
+    // sec is the view's copy under -pipeline.
+    if (spritesectors[sec-viewsectors] == spriteview)
 	return;		
 
     // Well, now it will be done.
-    sec->validcount = validcount;
+    spritesectors[sec-viewsectors] = spriteview;
 	
     lightnum = (sec->lightlevel >> LIGHTSEGSHIFT)+extralight;
 
@@ -751,7 +825,8 @@ void R_DrawPlayerSprites (void)
     
     // get light level
     lightnum =
-	(viewplayer->mo->subsector->sector->lightlevel >> LIGHTSEGSHIFT) 
+	(VIEWSECTOR(viewplayer->mo->subsector->sector)->lightlevel
+	 >> LIGHTSEGSHIFT)
 	+extralight;
 
     if (lightnum < 0)		
@@ -781,7 +856,7 @@ void R_DrawPlayerSprites (void)
 //
 // R_SortVisSprites
 //
-vissprite_t	vsprsortedhead;
+VIEWSTATE vissprite_t	vsprsortedhead;
 
 
 void R_SortVisSprites (void)
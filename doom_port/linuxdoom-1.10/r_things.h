@@ -30,9 +30,9 @@
 
 #define MAXVISSPRITES  	128
 
-extern vissprite_t	vissprites[MAXVISSPRITES];
-extern vissprite_t*	vissprite_p;
-extern vissprite_t	vsprsortedhead;
+extern VIEWSTATE vissprite_t	vissprites[MAXVISSPRITES];
+extern VIEWSTATE vissprite_t*	vissprite_p;
+extern VIEWSTATE vissprite_t	vsprsortedhead;
 
 // Constant arrays used for psprite clipping
 //  and initializing clipping.
@@ -40,16 +40,16 @@ extern short		negonearray[SCREENWIDTH];
 extern short		screenheightarray[SCREENWIDTH];
 
 // vars for R_DrawMaskedColumn
-extern short*		mfloorclip;
-extern short*		mceilingclip;
-extern fixed_t		spryscale;
-extern fixed_t		sprtopscreen;
+extern VIEWSTATE short*		mfloorclip;
+extern VIEWSTATE short*		mceilingclip;
+extern VIEWSTATE fixed_t		spryscale;
+extern VIEWSTATE fixed_t		sprtopscreen;
 
 extern fixed_t		pspritescale;
 extern fixed_t		pspriteiscale;
 
 
-void R_DrawMaskedColumn (column_t* column);
+void R_DrawMaskedColumn (rcolumn_t* column);
 
 
 void R_SortVisSprites (void);
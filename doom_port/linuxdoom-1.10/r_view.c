@@ -0,0 +1,316 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	More views per frame.
+//	The refresh state of a view is VIEWSTATE, so every thread
+//	 has its own, and the caches are held while threads share
+//	 zone memory. The game doesn't move while views are drawn.
+//
+//-----------------------------------------------------------------------------
+
+static const char
+rcsid[] = "$Id:$";
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+
+#include "z_zone.h"
+#include "i_system.h"
+#include "m_argv.h"
+
+#include "r_local.h"
+#include "r_pvs.h"
+
+#ifdef __GNUG__
+#pragma implementation "r_view.h"
+#endif
+#include "r_view.h"
+
+
+int		renderthreads;
+boolean		multiview;
+byte*		viewbuffers[MAXPLAYERS];
+
+
+static viewjob_t	jobs[MAXVIEWS];
+static int		numjobs;
+static int		nextjob;	// next one nobody has taken
+static int		jobsleft;	// not finished yet
+static boolean		jobfloat;	// floatrender of the caller
+
+static pthread_mutex_t	joblock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	jobready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t	jobsdone = PTHREAD_COND_INITIALIZER;
+
+static int		numworkers;
+
+
+
+//
+// R_InitViews
+//
+void R_InitViews (void)
+{
+    int		p;
+
+    renderthreads = sysconf (_SC_NPROCESSORS_ONLN);
+    p = M_CheckParm ("-rthreads");
+    if (p && p < myargc-1)
+	renderthreads = atoi (myargv[p+1]);
+    if (renderthreads < 1)
+	renderthreads = 1;
+
+    multiview = M_CheckParm ("-multiview");
+    pipeline = M_CheckParm ("-pipeline");
+}
+
+
+
+//
+// R_RenderViewTo
+// No NetUpdate or profiling here,
+//  this may not be the main thread.
+//
+void
+R_RenderViewTo
+( player_t*	player,
+  byte*		buffer )
+{
+    byte*	saverows[SCREENHEIGHT];
+    int		savecolumns[SCREENWIDTH];
+    int		width;
+    int		i;
+
+    // the displayed view may be on this thread too
+    width = viewwidth<<detailshift;
+    memcpy (saverows, ylookup, viewheight*sizeof(*ylookup));
+    memcpy (savecolumns, columnofs, width*sizeof(*columnofs));
+
+    for (i=0 ; i<width ; i++)
+	columnofs[i] = i;
+    for (i=0 ; i<viewheight ; i++)
+	ylookup[i] = buffer + i*SCREENWIDTH;
+
+    // a new thread has no drawer yet
+    colfunc = basecolfunc;
+
+    R_SetupFrame (player);
+    R_SetupFramePVS ();
+
+    R_ClearClipSegs ();
+    R_ClearDrawSegs ();
+    R_ClearPlanes ();
+    R_ClearSprites ();
+
+    R_RenderBSPNode (numnodes-1);
+    R_DrawPlanes ();
+    R_DrawMasked ();
+
+    memcpy (ylookup, saverows, viewheight*sizeof(*ylookup));
+    memcpy (columnofs, savecolumns, width*sizeof(*columnofs));
+}
+
+
+
+//
+// R_RunJob
+//
+static void R_RunJob (viewjob_t* job)
+{
+    floatrender = jobfloat;
+    mainview = job->mapping;
+    viewsnap = job->snap;
+
+    R_RenderViewTo (job->player, job->buffer);
+
+    viewsnap = NULL;
+    mainview = false;
+}
+
+
+
+//
+// R_ViewThread
+//
+static void* R_ViewThread (void* unused)
+{
+    viewjob_t*	job;
+
+    pthread_mutex_lock (&joblock);
+    for (;;)
+    {
+	while (nextjob == numjobs)
+	    pthread_cond_wait (&jobready, &joblock);
+	job = &jobs[nextjob++];
+	pthread_mutex_unlock (&joblock);
+
+	R_RunJob (job);
+
+	pthread_mutex_lock (&joblock);
+	if (!--jobsleft)
+	    pthread_cond_signal (&jobsdone);
+    }
+    return NULL;
+}
+
+
+
+//
+// R_StartJobs
+//
+void
+R_StartJobs
+( viewjob_t*	views,
+  int		count )
+{
+    pthread_t	thread;
+
+    if (count > MAXVIEWS)
+	I_Error ("R_StartJobs: %i views, max is %i", count, MAXVIEWS);
+
+    // the pool is only started once there is work for it
+    while (numworkers < renderthreads-1)
+    {
+	// before there is anyone to race with
+	zonelocking = true;
+	if (pthread_create (&thread, NULL, R_ViewThread, NULL))
+	    I_Error ("R_StartJobs: couldn't start a thread");
+	pthread_detach (thread);
+	numworkers++;
+    }
+
+    R_HoldCache ();
+
+    pthread_mutex_lock (&joblock);
+    memcpy (jobs, views, count*sizeof(*jobs));
+    jobfloat = floatrender;
+    nextjob = 0;
+    jobsleft = count;
+    numjobs = count;
+    pthread_cond_broadcast (&jobready);
+    pthread_mutex_unlock (&joblock);
+}
+
+
+
+//
+// R_FinishViews
+//
+void R_FinishViews (void)
+{
+    viewjob_t*	job;
+
+    pthread_mutex_lock (&joblock);
+
+    // help with whatever the pool hasn't taken
+    while (nextjob < numjobs)
+    {
+	job = &jobs[nextjob++];
+	pthread_mutex_unlock (&joblock);
+
+	R_RunJob (job);
+
+	pthread_mutex_lock (&joblock);
+	jobsleft--;
+    }
+
+    while (jobsleft)
+	pthread_cond_wait (&jobsdone, &joblock);
+    numjobs = nextjob = 0;
+    pthread_mutex_unlock (&joblock);
+
+    R_ReleaseCache ();
+}
+
+
+
+//
+// R_StartViews
+//
+void
+R_StartViews
+( player_t**	players,
+  byte**	buffers,
+  int		count )
+{
+    viewjob_t	views[MAXVIEWS];
+    int		i;
+
+    if (count > MAXVIEWS)
+	I_Error ("R_StartViews: %i views, max is %i", count, MAXVIEWS);
+
+    for (i=0 ; i<count ; i++)
+    {
+	views[i].player = players[i];
+	views[i].buffer = buffers[i];
+	views[i].snap = NULL;
+	views[i].mapping = false;
+    }
+    R_StartJobs (views, count);
+}
+
+
+
+//
+// R_RenderViews
+//
+void
+R_RenderViews
+( player_t**	players,
+  byte**	buffers,
+  int		count )
+{
+    R_StartViews (players, buffers, count);
+    R_FinishViews ();
+}
+
+
+
+//
+// R_StartPlayerViews
+//
+void R_StartPlayerViews (player_t* shown)
+{
+    player_t*	views[MAXPLAYERS];
+    byte*	buffers[MAXPLAYERS];
+    int		count;
+    int		i;
+
+    count = 0;
+    for (i=0 ; i<MAXPLAYERS ; i++)
+    {
+	if (!playeringame[i] || !players[i].mo || &players[i] == shown)
+	    continue;
+
+	if (!viewbuffers[i])
+	    viewbuffers[i] = Z_Malloc (SCREENWIDTH*SCREENHEIGHT,
+				       PU_STATIC, NULL);
+	views[count] = &players[i];
+	buffers[count] = viewbuffers[i];
+	count++;
+    }
+
+    R_StartViews (views, buffers, count);
+}
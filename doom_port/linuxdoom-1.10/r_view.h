@@ -0,0 +1,105 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	More views per frame, drawn on a pool of threads
+//	 into buffers of their own.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __R_VIEW__
+#define __R_VIEW__
+
+#include "d_player.h"
+#include "r_snap.h"
+
+#ifdef __GNUG__
+#pragma interface
+#endif
+
+
+#define MAXVIEWS		16
+
+typedef struct
+{
+    player_t*		player;
+    byte*		buffer;
+
+    // NULL to draw the live world
+    snapshot_t*		snap;
+
+    // true for the view the automap follows
+    boolean		mapping;
+
+} viewjob_t;
+
+// Threads drawing views, the calling one included.
+// Set by -rthreads, one per processor by default.
+extern int		renderthreads;
+
+// Set by -multiview, every other player in the game
+//  is drawn into viewbuffers each frame as well.
+extern boolean		multiview;
+
+// SCREENWIDTH wide, viewwidth by viewheight of it drawn.
+// NULL for players that have had no view.
+extern byte*		viewbuffers[MAXPLAYERS];
+
+
+// Called by R_Init.
+void R_InitViews (void);
+
+// Draws a view into buffer on the calling thread.
+void
+R_RenderViewTo
+( player_t*	player,
+  byte*		buffer );
+
+// The views start on the pool, the caller can draw
+//  its own meanwhile, then R_FinishViews helps
+//  with the rest and waits for them.
+void
+R_StartViews
+( player_t**	players,
+  byte**	buffers,
+  int		count );
+
+void
+R_StartJobs
+( viewjob_t*	views,
+  int		count );
+
+void R_FinishViews (void);
+
+// Both of the above.
+void
+R_RenderViews
+( player_t**	players,
+  byte**	buffers,
+  int		count );
+
+// Starts every in-game player but the one shown,
+//  for -multiview.
+void R_StartPlayerViews (player_t* shown);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
@@ -197,15 +197,17 @@ V_CopyRect
  
 
 //
-// V_DrawPatch
-// Masks a column based masked pic to the screen. 
+// V_DrawRawPatch
+// A patch R_PeekPatch hasn't decoded yet,
+//  straight from the lump.
 //
-void
-V_DrawPatch
+static void
+V_DrawRawPatch
 ( int		x,
   int		y,
   int		scrn,
-  patch_t*	patch ) 
+  patch_t*	patch,
+  boolean	flip ) 
 { 
 
     int		count;
@@ -242,7 +244,8 @@ V_DrawPatch
 
     for ( ; col<w ; x++, col++, desttop++)
     { 
-	column = (column_t *)((byte *)patch + LONG(patch->columnofs[col])); 
+	column = (column_t *)((byte *)patch
+			      + LONG(patch->columnofs[flip ? w-1-col : col])); 
  
 	// step through the posts in a column 
 	while (column->topdelta != 0xff ) 
@@ -261,6 +264,81 @@ V_DrawPatch
 	} 
     }			 
 } 
+
+
+//
+// V_DrawPatch
+// Masks a column based masked pic to the screen. 
+//
+void
+V_DrawPatch
+( int		x,
+  int		y,
+  int		scrn,
+  patch_t*	patch ) 
+{ 
+
+    int		count;
+    int		col; 
+    rpatch_t*	rpatch;
+    rcolumn_t*	column; 
+    rpost_t*	post;
+    int		i;
+    byte*	desttop;
+    byte*	dest;
+    byte*	source; 
+    int		w; 
+	 
+    rpatch = R_PeekPatch (patch);
+    if (!rpatch)
+    {
+	V_DrawRawPatch (x, y, scrn, patch, false);
+	return;
+    }
+
+    y -= rpatch->topoffset; 
+    x -= rpatch->leftoffset; 
+#ifdef RANGECHECK 
+    if (x<0
+	||x+rpatch->width >SCREENWIDTH
+	|| y<0
+	|| y+rpatch->height>SCREENHEIGHT 
+	|| (unsigned)scrn>4)
+    {
+      fprintf( stderr, "Patch at %d,%d exceeds LFB\n", x,y );
+      // No I_Error abort - what is up with TNT.WAD?
+      fprintf( stderr, "V_DrawPatch: bad patch (ignored)\n");
+      return;
+    }
+#endif 
+ 
+    if (!scrn)
+	V_MarkRect (x, y, rpatch->width, rpatch->height); 
+
+    col = 0; 
+    desttop = screens[scrn]+y*SCREENWIDTH+x; 
+	 
+    w = rpatch->width; 
+
+    for ( ; col<w ; x++, col++, desttop++)
+    { 
+	column = &rpatch->columns[col]; 
+ 
+	// step through the posts in a column 
+	for (i=0, post=column->posts ; i<column->numposts ; i++, post++)
+	{ 
+	    source = post->pixels; 
+	    dest = desttop + post->topdelta*SCREENWIDTH; 
+	    count = post->length; 
+			 
+	    while (count--) 
+	    { 
+		*dest = *source++; 
+		dest += SCREENWIDTH; 
+	    } 
+	} 
+    }			 
+} 
  
 //
 // V_DrawPatchFlipped 
@@ -277,19 +355,29 @@ V_DrawPatchFlipped
 
     int		count;
     int		col; 
-    column_t*	column; 
+    rpatch_t*	rpatch;
+    rcolumn_t*	column; 
+    rpost_t*	post;
+    int		i;
     byte*	desttop;
     byte*	dest;
     byte*	source; 
     int		w; 
 	 
-    y -= SHORT(patch->topoffset); 
-    x -= SHORT(patch->leftoffset); 
+    rpatch = R_PeekPatch (patch);
+    if (!rpatch)
+    {
+	V_DrawRawPatch (x, y, scrn, patch, true);
+	return;
+    }
+
+    y -= rpatch->topoffset; 
+    x -= rpatch->leftoffset; 
 #ifdef RANGECHECK 
     if (x<0
-	||x+SHORT(patch->width) >SCREENWIDTH
+	||x+rpatch->width >SCREENWIDTH
 	|| y<0
-	|| y+SHORT(patch->height)>SCREENHEIGHT 
+	|| y+rpatch->height>SCREENHEIGHT 
 	|| (unsigned)scrn>4)
     {
       fprintf( stderr, "Patch origin %d,%d exceeds LFB\n", x,y );
@@ -298,31 +386,29 @@ V_DrawPatchFlipped
 #endif 
  
     if (!scrn)
-	V_MarkRect (x, y, SHORT(patch->width), SHORT(patch->height)); 
+	V_MarkRect (x, y, rpatch->width, rpatch->height); 
 
     col = 0; 
     desttop = screens[scrn]+y*SCREENWIDTH+x; 
 	 
-    w = SHORT(patch->width); 
+    w = rpatch->width; 
 
-    for ( ; col<w ; x++, col++, desttop++) 
+    for ( ; col<w ; x++, col++, desttop++)
     { 
-	column = (column_t *)((byte *)patch + LONG(patch->columnofs[w-1-col])); 
+	column = &rpatch->columns[w-1-col]; 
  
 	// step through the posts in a column 
-	while (column->topdelta != 0xff ) 
+	for (i=0, post=column->posts ; i<column->numposts ; i++, post++)
 	{ 
-	    source = (byte *)column + 3; 
-	    dest = desttop + column->topdelta*SCREENWIDTH; 
-	    count = column->length; 
+	    source = post->pixels; 
+	    dest = desttop + post->topdelta*SCREENWIDTH; 
+	    count = post->length; 
 			 
 	    while (count--) 
 	    { 
 		*dest = *source++; 
 		dest += SCREENWIDTH; 
 	    } 
-	    column = (column_t *)(  (byte *)column + column->length 
-				    + 4 ); 
 	} 
     }			 
 } 
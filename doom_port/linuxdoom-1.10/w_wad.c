@@ -481,6 +481,9 @@ W_CacheLumpNum
     if ((unsigned)lump >= numlumps)
 	I_Error ("W_CacheLumpNum: %i >= numlumps",lump);
 		
+    // two threads may want the same lump
+    Z_Lock ();
+
     if (!lumpcache[lump])
     {
 	// read the lump in
@@ -494,12 +497,37 @@ W_CacheLumpNum
 	//printf ("cache hit on lump %i\n",lump);
 	Z_ChangeTag (lumpcache[lump],tag);
     }
+
+    ptr = lumpcache[lump];
+    Z_Unlock ();
 	
-    return lumpcache[lump];
+    return ptr;
 }
 
 
 
+//
+// W_LumpNumForCache
+// Which lump a pointer from W_CacheLumpNum holds,
+//  -1 if it isn't one.
+//
+int W_LumpNumForCache (void* ptr)
+{
+    memblock_t*	block;
+    int		lump;
+
+    block = (memblock_t *)((byte *)ptr - sizeof(memblock_t));
+    if (block->id != 0x1d4a11 || !block->user)
+	return -1;
+
+    lump = (void **)block->user - lumpcache;
+    if (lump < 0 || lump >= numlumps || lumpcache[lump] != ptr)
+	return -1;
+
+    return lump;
+}
+
+
 //
 // W_CacheLumpName
 //
@@ -78,6 +78,8 @@ void    W_ReadLump (int lump, void *dest);
 void*	W_CacheLumpNum (int lump, int tag);
 void*	W_CacheLumpName (char* name, int tag);
 
+int	W_LumpNumForCache (void* ptr);
+
 
 
 
@@ -24,6 +24,8 @@
 static const char
 rcsid[] = "$Id: z_zone.c,v 1.4 1997/02/03 16:47:58 b1 Exp $";
 
+#include <pthread.h>
+
 #include "z_zone.h"
 #include "i_system.h"
 #include "doomdef.h"
@@ -59,6 +61,9 @@ typedef struct
 
 memzone_t*	mainzone;
 
+int		zonelocking;
+static pthread_mutex_t	zonelock;
+
 
 
 //
@@ -87,13 +92,37 @@ void Z_ClearZone (memzone_t* zone)
 
 
 
+//
+// Z_Lock
+// Z_Unlock
+// Recursive, Z_Malloc frees what it purges.
+//
+void Z_Lock (void)
+{
+    if (zonelocking)
+	pthread_mutex_lock (&zonelock);
+}
+
+void Z_Unlock (void)
+{
+    if (zonelocking)
+	pthread_mutex_unlock (&zonelock);
+}
+
+
 //
 // Z_Init
 //
 void Z_Init (void)
 {
-    memblock_t*	block;
-    int		size;
+    memblock_t*		block;
+    int			size;
+    pthread_mutexattr_t	attr;
+
+    pthread_mutexattr_init (&attr);
+    pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init (&zonelock, &attr);
+    pthread_mutexattr_destroy (&attr);
 
     mainzone = (memzone_t *)I_ZoneBase (&size);
     mainzone->size = size;
@@ -128,6 +157,8 @@ void Z_Free (void* ptr)
 
     if (block->id != ZONEID)
 	I_Error ("Z_Free: freed a pointer without ZONEID");
+
+    Z_Lock ();
 		
     if (block->user > (void **)0x100)
     {
@@ -169,6 +200,8 @@ void Z_Free (void* ptr)
 	if (other == mainzone->rover)
 	    mainzone->rover = block;
     }
+
+    Z_Unlock ();
 }
 
 
@@ -193,6 +226,8 @@ Z_Malloc
     memblock_t*	base;
 
     size = (size + 3) & ~3;
+
+    Z_Lock ();
     
     // scan through the block list,
     // looking for the first free block
@@ -284,6 +319,8 @@ Z_Malloc
     mainzone->rover = base->next;	
 	
     base->id = ZONEID;
+
+    Z_Unlock ();
     
     return (void *) ((byte *)base + sizeof(memblock_t));
 }
@@ -300,6 +337,8 @@ Z_FreeTags
 {
     memblock_t*	block;
     memblock_t*	next;
+
+    Z_Lock ();
 	
     for (block = mainzone->blocklist.next ;
 	 block != &mainzone->blocklist ;
@@ -315,6 +354,8 @@ Z_FreeTags
 	if (block->tag >= lowtag && block->tag <= hightag)
 	    Z_Free ( (byte *)block+sizeof(memblock_t));
     }
+
+    Z_Unlock ();
 }
 
 
@@ -440,7 +481,9 @@ Z_ChangeTag2
     if (tag >= PU_PURGELEVEL && (unsigned)block->user < 0x100)
 	I_Error ("Z_ChangeTag: an owner is required for purgable blocks");
 
+    Z_Lock ();
     block->tag = tag;
+    Z_Unlock ();
 }
 
 
@@ -54,6 +54,12 @@ void    Z_CheckHeap (void);
 void    Z_ChangeTag2 (void *ptr, int tag);
 int     Z_FreeMemory (void);
 
+// Set once render threads share the zone,
+//  every change to it is made under a lock then.
+extern int	zonelocking;
+void    Z_Lock (void);
+void    Z_Unlock (void);
+
 
 typedef struct memblock_s
 {